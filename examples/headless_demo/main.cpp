@@ -0,0 +1,84 @@
+/**
+ * SGUI 无窗口（headless）渲染演示程序
+ *
+ * 不需要显示器即可运行：
+ * - 控件树渲染到内存中的图像表面
+ * - 通过Inject*注入鼠标事件
+ * - 使用虚拟时钟逐帧推进主循环
+ * - 把每一帧保存为PNG/PPM，用于性能分析和渲染回归测试
+ */
+
+#include <sgui_window.h>
+#include <sgui_button.h>
+#include <sgui_container.h>
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+using namespace sgui;
+
+int main() {
+    std::cout << "=== SGUI 无窗口渲染演示 ===\n\n";
+
+    // 创建无窗口模式的窗口管理器
+    SWindowManager manager(WindowBackend::Headless);
+    manager.SetLoopMode(LoopMode::EventDriven);
+
+    auto window = manager.CreateWindow(400, 300, "SGUI Headless Demo");
+    if (!window) {
+        std::cerr << "Failed to create headless window" << std::endl;
+        return -1;
+    }
+    window->SetTargetFrameRate(60.0);
+
+    // 创建控件树
+    auto rootContainer = std::make_shared<SContainer>();
+    rootContainer->setBackgroundColor(Color::White());
+    rootContainer->setPadding(EdgeInsets::All(40.0f));
+    rootContainer->setAlignItems(Align::Center);
+
+    auto button = std::make_shared<SButton>("Click me");
+    button->setWidth(LayoutValue::Point(200));
+    button->setHeight(LayoutValue::Point(50));
+    button->setNormalBackgroundColor(Color::LightGray());
+    button->setHoverBackgroundColor(Color::Gray());
+    button->setPressedBackgroundColor(Color::DarkGray());
+    button->setBorderRadius(EdgeInsets::All(6.0f));
+
+    int clicks = 0;
+    button->setOnClick([&clicks](const MouseEvent& event) {
+        clicks++;
+    });
+    rootContainer->addChild(button);
+    window->SetRootContainer(rootContainer);
+
+    const auto frame = std::chrono::milliseconds(16);
+
+    // 第一帧
+    manager.RunFrame();
+    window->SaveFrame("headless_frame0.png");
+
+    // 鼠标移动到按钮上方并点击
+    window->InjectMouseMove(200, 65);
+    manager.AdvanceTime(frame);
+    manager.RunFrame();
+    window->SaveFrame("headless_frame1_hover.png");
+
+    window->InjectMouseButton(MouseButton::Left, true);
+    manager.AdvanceTime(frame);
+    manager.RunFrame();
+    window->SaveFrame("headless_frame2_pressed.ppm");
+
+    window->InjectMouseButton(MouseButton::Left, false);
+    manager.AdvanceTime(frame);
+    manager.RunFrame();
+    window->SaveFrame("headless_frame3_released.png");
+
+    FrameStats stats = window->GetFrameStats();
+    std::cout << "Frames rendered: " << stats.frameCount << ", clicks: " << clicks << std::endl;
+
+    // 没有待处理的工作时Run()直接返回
+    window->Close();
+    manager.Run();
+    return 0;
+}
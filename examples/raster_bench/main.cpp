@@ -0,0 +1,119 @@
+/**
+ * SGUI 图块并行光栅化性能测试
+ *
+ * 在3840x2160的无窗口后缓冲上绘制一个由大量带背景、边框、圆角和文字的容器组成的网格，
+ * 把控件树记录为帧显示列表后，分别用1..N个线程按图块回放，统计每帧耗时和相对串行的加速比，
+ * 并逐字节比较每种线程数的输出与串行结果是否一致。
+ */
+
+#include <sgui_cairo_renderer.h>
+#include <sgui_container.h>
+#include <sgui_display_list.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace sgui;
+
+namespace {
+
+const int kWidth = 3840;
+const int kHeight = 2160;
+const int kFrames = 10;
+
+std::shared_ptr<SContainer> buildTree() {
+    auto root = std::make_shared<SContainer>();
+    root->setBackgroundColor(Color::White());
+    root->setFlexDirection(FlexDirection::Row);
+    root->setFlexWrap(FlexWrap::Wrap);
+    root->setPadding(EdgeInsets::All(8.0f));
+
+    const Color colors[] = {Color::LightGray(), Color::Silver(), Color::Aqua(), Color::Pink(), Color::Lime()};
+    for (int i = 0; i < 1200; ++i) {
+        auto cell = std::make_shared<SContainer>();
+        cell->setWidth(LayoutValue::Point(140));
+        cell->setHeight(LayoutValue::Point(56));
+        cell->setMargin(EdgeInsets::All(4.0f));
+        cell->setBorder(EdgeInsets::All(1.0f));
+        cell->setBorderColor(Color::DarkGray());
+        cell->setBorderRadius(EdgeInsets::All(6.0f));
+        cell->setBackgroundColor(colors[i % 5]);
+        cell->setFontSize(14.0f);
+        cell->setText("Item " + std::to_string(i));
+        root->addChild(cell);
+    }
+    root->calculateLayout(kWidth, kHeight);
+    return root;
+}
+
+double rasterizeFrames(SCairoRenderer& renderer, const SDisplayList& list) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kFrames; ++i) {
+        renderer.begin();
+        renderer.rasterize(list);
+        renderer.end();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / kFrames;
+}
+
+std::vector<unsigned char> snapshot(SCairoRenderer& renderer) {
+    cairo_surface_t* surface = renderer.getBackSurface();
+    cairo_surface_flush(surface);
+    const unsigned char* data = cairo_image_surface_get_data(surface);
+    size_t bytes = static_cast<size_t>(cairo_image_surface_get_stride(surface)) * kHeight;
+    return std::vector<unsigned char>(data, data + bytes);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int tileSize = argc > 1 ? std::atoi(argv[1]) : 256;
+    int maxThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    std::cout << "=== SGUI 图块并行光栅化性能测试 (" << kWidth << "x" << kHeight << ", 图块 " << tileSize
+              << ") ===\n\n";
+
+    auto root = buildTree();
+    SDisplayList list;
+    root->recordDisplayList(list, CAIRO_ANTIALIAS_SUBPIXEL);
+
+    SCairoRenderer renderer(nullptr, kWidth, kHeight);
+    renderer.setTileSize(tileSize);
+
+    // 串行结果作为基准
+    renderer.setRasterThreads(1);
+    rasterizeFrames(renderer, list);
+    double serialMs = rasterizeFrames(renderer, list);
+    std::vector<unsigned char> reference = snapshot(renderer);
+
+    std::cout << "线程数  图块数  每帧耗时(ms)  加速比  输出一致\n";
+    bool allMatch = true;
+    for (int threads = 1; threads <= maxThreads; ++threads) {
+        renderer.setRasterThreads(threads);
+
+        // 清空后缓冲，确保比较的是本次回放的结果
+        renderer.begin();
+        cairo_t* cr = renderer.getContext();
+        cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+        cairo_paint(cr);
+        cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+        renderer.end();
+
+        double ms = rasterizeFrames(renderer, list);
+        bool match = snapshot(renderer) == reference;
+        allMatch = allMatch && match;
+
+        const RasterStats& stats = renderer.getRasterStats();
+        std::cout << threads << "\t" << stats.tiles << "\t" << ms << "\t\t" << serialMs / ms << "\t"
+                  << (match ? "是" : "否") << "\n";
+    }
+
+    return allMatch ? 0 : 1;
+}
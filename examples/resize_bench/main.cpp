@@ -0,0 +1,127 @@
+/**
+ * SGUI 调整大小性能测试
+ *
+ * 模拟交互式拖动窗口边框：窗口从800x600逐步放大到3840x2160再缩小回来，
+ * 每一步调用一次resize()并绘制一帧，统计每次resize的耗时和后缓冲分配次数。
+ *
+ * 默认使用无窗口渲染器，不需要显示器；传入--window参数时在真实的X11窗口上测试，
+ * 此时还会经过xlib前缓冲和共享内存呈现路径。
+ */
+
+#include <sgui_cairo_renderer.h>
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+#ifdef __linux__
+#define GLFW_EXPOSE_NATIVE_X11
+#include <GLFW/glfw3native.h>
+#endif
+
+using namespace sgui;
+
+namespace {
+
+struct Size {
+    int width;
+    int height;
+};
+
+// 拖动轨迹上的第i个尺寸（共steps步放大，再steps步缩小）
+Size dragSize(int i, int steps) {
+    const Size from = {800, 600};
+    const Size to = {3840, 2160};
+    int k = i <= steps ? i : 2 * steps - i;
+    return {from.width + (to.width - from.width) * k / steps, from.height + (to.height - from.height) * k / steps};
+}
+
+void drawFrame(SCairoRenderer& renderer, int width, int height) {
+    renderer.begin();
+    cairo_t* cr = renderer.getContext();
+    if (cr) {
+        cairo_set_source_rgb(cr, 0.95, 0.95, 0.95);
+        cairo_paint(cr);
+        cairo_set_source_rgb(cr, 0.2, 0.4, 0.8);
+        cairo_rectangle(cr, 20, 20, width - 40, height - 40);
+        cairo_stroke(cr);
+    }
+    renderer.end();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool useWindow = argc > 1 && std::strcmp(argv[1], "--window") == 0;
+    const int steps = 200;
+
+    std::cout << "=== SGUI 调整大小性能测试 (" << (useWindow ? "X11窗口" : "无窗口") << ") ===\n\n";
+
+    GLFWwindow* window = nullptr;
+    void* windowId = nullptr;
+    void* display = nullptr;
+    if (useWindow) {
+#ifdef __linux__
+        if (!glfwInit()) {
+            std::cerr << "Failed to initialize GLFW" << std::endl;
+            return -1;
+        }
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+        window = glfwCreateWindow(800, 600, "SGUI Resize Benchmark", nullptr, nullptr);
+        if (!window) {
+            std::cerr << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        windowId = reinterpret_cast<void*>(glfwGetX11Window(window));
+        display = glfwGetX11Display();
+#else
+        std::cerr << "--window is only supported on X11" << std::endl;
+        return -1;
+#endif
+    }
+
+    {
+        SCairoRenderer renderer(windowId, 800, 600, display);
+        drawFrame(renderer, 800, 600);
+        uint64_t initialAllocations = renderer.getResizeStats().backBufferAllocations;
+
+        double totalMs = 0.0;
+        double maxMs = 0.0;
+        for (int i = 1; i <= 2 * steps; ++i) {
+            Size size = dragSize(i, steps);
+            if (window) {
+                glfwSetWindowSize(window, size.width, size.height);
+                glfwPollEvents();
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            renderer.resize(size.width, size.height);
+            auto end = std::chrono::steady_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(end - start).count();
+            totalMs += ms;
+            if (ms > maxMs) {
+                maxMs = ms;
+            }
+
+            drawFrame(renderer, size.width, size.height);
+        }
+
+        const ResizeStats& stats = renderer.getResizeStats();
+        uint64_t allocations = stats.backBufferAllocations - initialAllocations;
+        std::cout << "resize次数:          " << stats.resizes << "\n";
+        std::cout << "后缓冲分配次数:      " << allocations << "\n";
+        std::cout << "每次resize分配次数:  " << static_cast<double>(allocations) / stats.resizes << "\n";
+        std::cout << "存储池复用次数:      " << stats.backBufferReuses << "\n";
+        std::cout << "平均resize耗时:      " << totalMs / stats.resizes << " ms\n";
+        std::cout << "最大resize耗时:      " << maxMs << " ms\n";
+        std::cout << "共享内存呈现:        " << (renderer.isSharedMemoryPresent() ? "是" : "否") << "\n";
+    }
+
+    if (window) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
+    return 0;
+}
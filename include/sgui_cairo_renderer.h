@@ -6,13 +6,49 @@
 #pragma once
 
 #include <cairo/cairo.h>
+#include <atomic>
 #include <memory>
 #include <string>
+#include <vector>
+#include <cstdint>
 #include "sgui_common.h"
 
 
 namespace sgui {
 
+class SXShmPresenter;
+class SDisplayList;
+struct SBackBuffer;
+
+/**
+ * 呈现统计信息
+ *
+ * 字节数按后缓冲的像素格式（ARGB32，每像素4字节）计算
+ */
+struct PresentStats {
+    uint64_t lastFrameBytes = 0; // 最近一次呈现复制的字节数
+    uint64_t lastFrameRects = 0; // 最近一次呈现复制的矩形数
+    uint64_t totalBytes = 0;     // 累计呈现的字节数
+    uint64_t frames = 0;         // 累计呈现次数
+};
+
+/**
+ * 调整大小统计信息
+ */
+struct ResizeStats {
+    uint64_t resizes = 0;               // resize()改变尺寸的次数
+    uint64_t backBufferAllocations = 0; // 后缓冲存储的新分配次数（包括初始化）
+    uint64_t backBufferReuses = 0;      // 从存储池复用后缓冲存储的次数
+};
+
+/**
+ * 光栅化统计信息（最近一次rasterize）
+ */
+struct RasterStats {
+    uint64_t tiles = 0;   // 回放的图块数
+    uint64_t threads = 0; // 实际参与回放的线程数
+};
+
 /**
  * Cairo渲染器类
  * 
@@ -23,11 +59,14 @@ class SCairoRenderer {
 public:
     /**
      * 构造函数
-     * @param windowId 窗口ID（HWND或X11 Window）
+     * @param windowId 窗口ID（HWND或X11 Window），为nullptr时创建无窗口（headless）渲染器，
+     *                 只绘制到内存中的后缓冲，end()不做呈现
      * @param width 渲染器宽度
      * @param height 渲染器高度
+     * @param nativeDisplay 窗口所属的原生显示连接（X11的Display*），由调用者管理生命周期；
+     *                      为nullptr时渲染器自己打开一个连接并在析构时关闭
      */
-    SCairoRenderer(void* windowId, int width, int height);
+    SCairoRenderer(void* windowId, int width, int height, void* nativeDisplay = nullptr);
     
     /**
      * 析构函数
@@ -42,6 +81,7 @@ public:
     
     /**
      * 调整渲染器大小
+     * 前缓冲只更新尺寸；后缓冲的存储只在需要变大时重新分配，缩小时复用原来的存储
      * @param width 新宽度
      * @param height 新高度
      */
@@ -55,7 +95,7 @@ public:
     
     /**
      * 开始绘制
-     * 清除后缓冲并准备绘制
+     * 后缓冲保留上一帧的内容，只把新分配或新露出、内容未定义的区域清除为白色
      */
     void begin();
     
@@ -64,11 +104,100 @@ public:
      * 将后缓冲内容复制到前缓冲（窗口）
      */
     void end();
+
+    /**
+     * 结束绘制，只把后缓冲中的指定矩形复制到前缓冲
+     * 用于局部重绘后的快速呈现
+     */
+    void end(int x, int y, int width, int height);
+
+    /**
+     * 结束绘制，只把后缓冲中损坏区域内的像素复制到前缓冲
+     * 区域中的矩形按代价模型合并为不超过kMaxPresentRects个矩形：
+     * 每个矩形有固定的请求开销，合并浪费的面积小于该开销时合并
+     * @param damage 损坏区域，为nullptr时呈现整个表面
+     */
+    void end(const cairo_region_t* damage);
+
+    /**
+     * 把帧显示列表光栅化到后缓冲
+     * 后缓冲划分为getTileSize()大小的图块，与损坏区域相交的图块由调用线程和SThreadPool的工作线程动态领取并行回放，
+     * 线程池忙于其他任务时调用线程自己回放剩余的图块，不等待排队的任务；
+     * 每个图块使用独立的表面视图和cairo上下文并裁剪到图块内的损坏区域，
+     * 各图块写入互不重叠的像素，结果与串行回放逐像素一致
+     * @param list 帧显示列表
+     * @param damage 需要重绘的区域，为nullptr时重绘整个表面
+     */
+    void rasterize(const SDisplayList& list, const cairo_region_t* damage = nullptr);
+
+    /**
+     * 设置图块边长（像素），默认256
+     */
+    void setTileSize(int size);
+    int getTileSize() const { return m_tileSize; }
+
+    /**
+     * 设置光栅化使用的线程数（包括调用线程）
+     * 1为串行回放（默认），0为使用线程池的全部工作线程
+     */
+    void setRasterThreads(int threads);
+    int getRasterThreads() const { return m_rasterThreads.load(); }
+
+    /**
+     * 获取最近一次光栅化的统计信息
+     */
+    const RasterStats& getRasterStats() const { return m_rasterStats; }
+
+    /**
+     * 是否使用X11共享内存（MIT-SHM）呈现
+     * 服务器不支持该扩展、视觉格式不兼容或设置了环境变量SGUI_DISABLE_XSHM时回退到xlib surface
+     */
+    bool isSharedMemoryPresent() const { return m_shmPresenter != nullptr; }
+
+    /**
+     * 获取呈现统计信息
+     */
+    const PresentStats& getPresentStats() const { return m_presentStats; }
+
+    /**
+     * 获取调整大小统计信息
+     */
+    const ResizeStats& getResizeStats() const { return m_resizeStats; }
+
+    /**
+     * 单次呈现最多复制的矩形数
+     */
+    static constexpr int kMaxPresentRects = 8;
+
+    /**
+     * 是否为无窗口渲染器
+     */
+    bool isHeadless() const { return m_windowId == nullptr; }
+
+    /**
+     * 获取后缓冲表面
+     * 无窗口模式下即为最终的帧图像，与窗口模式的后缓冲逐像素一致
+     */
+    cairo_surface_t* getBackSurface() const { return m_backSurface; }
+
+    /**
+     * 将后缓冲保存为PNG文件
+     * @return 成功返回true
+     */
+    bool writeToPng(const std::string& path) const;
+
+    /**
+     * 将后缓冲保存为PPM（P6）文件，颜色已去除预乘alpha
+     * @return 成功返回true
+     */
+    bool writeToPpm(const std::string& path) const;
     
     
 
 private:
     void* m_windowId;  // 窗口ID
+    void* m_display = nullptr;  // X11 Display*
+    bool m_ownsDisplay = false; // 显示连接由渲染器打开，需要在析构时关闭
     int m_width;
     int m_height;
     
@@ -76,15 +205,76 @@ private:
     cairo_surface_t* m_frontSurface;
     cairo_t* m_frontCairo;
     
-    // 后缓冲（内存中的图像表面）
+    // 后缓冲（内存中的图像表面，是后缓冲存储左上角区域的视图）
     cairo_surface_t* m_backSurface;
     cairo_t* m_backCairo;
+
+    // 后缓冲存储（来自SBackBufferPool），尺寸不小于渲染器尺寸
+    std::unique_ptr<SBackBuffer> m_backStorage;
+    int m_bufferWidth = 0;
+    int m_bufferHeight = 0;
+    int m_bufferStride = 0;
+    ResizeStats m_resizeStats;
+
+    // 存储左上角内容有效（已经清除或绘制过）的范围，换用新存储时为0
+    int m_validWidth = 0;
+    int m_validHeight = 0;
+    // 内容未定义、下次begin()时清除为白色的区域（新存储或新露出的部分，可能残留其他窗口的像素）
+    cairo_region_t* m_pendingClear;
+
+    // 图块光栅化
+    int m_tileSize = 256;
+    std::atomic<int> m_rasterThreads{1};
+    RasterStats m_rasterStats;
+
+    PresentStats m_presentStats;
+
+    // 共享内存呈现器（可用时后缓冲的像素位于共享内存中）
+    std::unique_ptr<SXShmPresenter> m_shmPresenter;
+    
+    /**
+     * 把后缓冲中的一组矩形复制到前缓冲并刷新，同时更新呈现统计
+     */
+    void presentRects(const std::vector<cairo_rectangle_int_t>& rects);
     
     /**
      * 初始化Cairo表面
      * 创建前缓冲和后缓冲
      */
     void initCairoSurface();
+
+    /**
+     * 创建后缓冲及其上下文
+     * @return 成功返回true
+     */
+    bool initBackBuffer();
+
+    /**
+     * 分配能容纳width x height的后缓冲存储（可用时使用共享内存）
+     * @return 成功返回true
+     */
+    bool allocateBackStorage(int width, int height);
+
+    /**
+     * 释放后缓冲存储
+     */
+    void releaseBackStorage();
+
+    /**
+     * 后缓冲存储的像素数据
+     */
+    unsigned char* backStorageData() const;
+
+    /**
+     * 在后缓冲存储上创建当前尺寸的表面视图及其上下文
+     * @return 成功返回true
+     */
+    bool createBackView();
+
+    /**
+     * 销毁后缓冲表面视图（不释放存储）
+     */
+    void destroyBackView();
     
     /**
      * 清理Cairo表面
@@ -686,6 +686,18 @@ enum class Overflow
     Scroll = 2   // 内容溢出时显示滚动条
 };
 
+/**
+ * @brief 层模式枚举
+ *
+ * 定义节点是否把子树缓存为层（渲染到缓存的图像表面）
+ */
+enum class LayerMode
+{
+    Auto = 0,   // 自动：裁剪溢出的大子树或绘制开销大且内容稳定的子树自动提升为层
+    Always = 1, // 总是作为层
+    Never = 2   // 从不作为层
+};
+
 /**
  * @brief 间距类型枚举
  * 
@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include "sgui_image_cache.h"
 #include "sgui_layout.h"
+#include "sgui_shadow_cache.h"
 #include <string>
 #include <utility>
 
@@ -209,6 +211,15 @@ class SContainer : public SLayout
     /** 重写测量函数 */
     void onMeasure(float width, float height, float &measuredWidth, float &measuredHeight) override;
 
+    /** 从控件树移除时取消未完成的背景图像解码 */
+    void onDetached() override;
+
+    /** 重写外部绘制函数：绘制外阴影，不受自身溢出裁剪的限制 */
+    void renderOutset(cairo_t *cr) override;
+
+    /** 重写绘制范围：包含外阴影 */
+    Rect getPaintBounds() const override;
+
     // ====================================================================
     // 样式管理
     // ====================================================================
@@ -267,6 +278,18 @@ class SContainer : public SLayout
             m_cb_mouse(event);
     }
 
+    /**
+     * 合并后的鼠标移动事件
+     *
+     * 高频鼠标移动事件会被合并，每帧只分发一次
+     * @param latest 本帧最后一次移动事件
+     * @param history 本帧所有移动事件（按时间顺序，包含latest），需要完整轨迹的控件（例如画布）可以重写本函数
+     */
+    virtual void onMouseMovedCoalesced(const MouseEvent &latest, const std::vector<MouseEvent> &history)
+    {
+        onMouseMoved(latest);
+    }
+
     /** 鼠标进入事件 */
     virtual void onMouseEntered(const MouseEvent &event)
     {
@@ -347,6 +370,19 @@ class SContainer : public SLayout
     /** 使用Cairo绘制背景 */
     void drawBackgroundCairo(cairo_t *cr, float x, float y, float width, float height);
 
+    /** 使用Cairo绘制内阴影（背景之上、边框之下，限制在边框以内） */
+    void drawInsetShadowCairo(cairo_t *cr, float x, float y, float width, float height);
+
+    /** 检查阴影是否可见（有颜色，并且有模糊、扩散或偏移） */
+    bool hasVisibleBoxShadow() const;
+
+    /**
+     * 计算阴影形状及其左上角的位置
+     * 外阴影为扩散后的盒子，内阴影为按扩散半径收缩并偏移后的洞
+     * @param x/y/width/height 外阴影为节点边界，内阴影为边框以内的区域
+     */
+    ShadowShape makeShadowShape(float x, float y, float width, float height, double &shapeX, double &shapeY) const;
+
     /** 使用Cairo绘制边框 */
     void drawBorderCairo(cairo_t *cr, float x, float y, float width, float height);
 
@@ -360,15 +396,41 @@ class SContainer : public SLayout
     /** 创建圆角矩形路径 */
     void createRoundedRectanglePath(cairo_t *cr, float x, float y, float width, float height, float radius);
 
-    /** 创建复杂圆角矩形路径（支持不同方向的圆角） */
+    /**
+     * 创建复杂圆角矩形路径（支持不同方向的圆角）
+     * 路径按尺寸缓存在节点上，填充背景、描边边框和裁剪时直接追加缓存的路径
+     */
     void createComplexRoundedRectanglePath(cairo_t *cr, float x, float y, float width, float height);
 
-    /** 设置背景源 */
-    void setupBackgroundSource(cairo_t *cr, float x, float y, float width, float height);
+    /**
+     * 获取原点在(0, 0)、指定尺寸的圆角矩形路径，缓存中没有时构建并替换最早的缓存项
+     */
+    const cairo_path_t *getRoundedRectanglePath(float width, float height);
+
+    /** 释放缓存的圆角矩形路径，圆角变化时调用 */
+    void releaseRoundedRectanglePaths();
+
+    /** 设置背景源，没有可绘制的背景时返回false */
+    bool setupBackgroundSource(cairo_t *cr, float x, float y, float width, float height);
 
     /** 清理背景资源 */
     void cleanupBackgroundSource();
 
+    /**
+     * 获取背景图像表面（调用者持有一个引用）
+     * 异步解码时图像还没有解码完成返回nullptr，此时先绘制背景色，解码完成后节点被标记为需要重绘
+     */
+    cairo_surface_t *acquireBackgroundImage();
+
+    /** 发起背景图像的异步解码请求 */
+    void requestBackgroundImage(ImageDecodePriority priority);
+
+    /** 取消未完成的背景图像解码 */
+    void cancelBackgroundImageRequest();
+
+    /** 释放缓存的背景渐变图案，渐变样式变化时调用 */
+    void releaseGradientPattern();
+
     /** 检查是否有圆角 */
     bool hasBorderRadius() const;
 
@@ -385,6 +447,28 @@ class SContainer : public SLayout
     /** 当前使用的表面（用于清理） */
     mutable cairo_surface_t *m_currentSurface = nullptr;
 
+    /** 背景渐变编译后的图案（来自全局渐变缓存）及其对应的区域尺寸 */
+    cairo_pattern_t *m_gradientPattern = nullptr;
+    float m_gradientWidth = 0.0f;
+    float m_gradientHeight = 0.0f;
+
+    /**
+     * 缓存的圆角矩形路径
+     * 同一个节点按背景区域、边框描边区域和节点边界使用几种不同的尺寸，每种尺寸占一项
+     */
+    struct RoundedPathEntry
+    {
+        float width = 0.0f;
+        float height = 0.0f;
+        cairo_path_t *path = nullptr;
+    };
+    static constexpr size_t kRoundedPathSlots = 4;
+    RoundedPathEntry m_roundedPaths[kRoundedPathSlots];
+    size_t m_nextRoundedPath = 0;
+
+    /** 背景图像的异步解码请求，完成后持有解码结果 */
+    SImageRequestPtr m_imageRequest;
+
     // callback
     MouseEventCallback m_cb_mouse{nullptr};
 };
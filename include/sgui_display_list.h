@@ -0,0 +1,141 @@
+/**
+ * 显示列表
+ *
+ * 节点的render()输出被记录为cairo recording surface（节点显示列表），
+ * 节点没有变化时直接回放记录的绘制命令，不再重新执行背景、边框和文字的绘制代码。
+ * 整棵控件树可以进一步记录为帧显示列表：由保存/恢复、平移、裁剪和回放节点记录组成的命令序列，
+ * 可以在其他线程回放（多线程光栅化），也可以保存下来用于帧捕获。
+ *
+ * 跨线程共享的规则：帧显示列表引用的所有表面（节点记录和层表面）在加入列表时已经完成绘制并刷新，
+ * 之后不再修改，需要变化时总是创建新表面。
+ * 层表面是图像表面，作为源只被读取，多个图块可以同时使用；
+ * 节点记录是recording surface，cairo回放时会写入它的内部状态，因此每个记录的回放由自己的互斥锁串行化。
+ */
+
+#pragma once
+
+#include <cairo/cairo.h>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "sgui_common.h"
+
+namespace sgui {
+
+/**
+ * 节点绘制记录
+ *
+ * 包装一个记录了节点绘制命令的recording surface，创建时刷新并且之后不再添加命令。
+ * 可以在任意线程回放；cairo回放时会修改recording surface的内部状态，同一个记录的回放由互斥锁串行化。
+ */
+class SRecording {
+public:
+    /**
+     * 构造函数
+     * @param surface recording surface，所有权转移给本对象
+     */
+    explicit SRecording(cairo_surface_t* surface);
+    ~SRecording();
+
+    SRecording(const SRecording&) = delete;
+    SRecording& operator=(const SRecording&) = delete;
+
+    /**
+     * 把记录的绘制命令回放到cr的当前用户坐标系
+     */
+    void replay(cairo_t* cr) const;
+
+    /**
+     * 记录的墨迹范围（节点坐标系），空记录的宽高为0
+     */
+    const Rect& getInkBounds() const { return m_inkBounds; }
+
+    /**
+     * 是否没有任何绘制命令
+     */
+    bool isEmpty() const { return m_inkBounds.isEmpty(); }
+
+    cairo_surface_t* getSurface() const { return m_surface; }
+
+private:
+    cairo_surface_t* m_surface;
+    Rect m_inkBounds;
+    mutable std::mutex m_replayMutex; // 串行化对同一个记录的回放
+};
+
+using SRecordingPtr = std::shared_ptr<SRecording>;
+
+/**
+ * 帧显示列表命令类型
+ */
+enum class DisplayOpType {
+    Save,          // cairo_save
+    Restore,       // cairo_restore
+    Translate,     // 平移(x, y)
+    ClipRect,      // 裁剪到矩形(x, y, width, height)
+    DrawRecording, // 在当前坐标系回放节点记录
+    DrawSurface    // 在设备坐标(x, y)处贴图（层缓存）
+};
+
+/**
+ * 帧显示列表命令
+ */
+struct DisplayOp {
+    DisplayOpType type = DisplayOpType::Save;
+    double x = 0.0;
+    double y = 0.0;
+    double width = 0.0;
+    double height = 0.0;
+    SRecordingPtr recording;                  // DrawRecording
+    std::shared_ptr<cairo_surface_t> surface; // DrawSurface，持有表面的引用
+};
+
+/**
+ * 帧显示列表类
+ *
+ * 记录完成后不再添加命令，可以在任意线程回放，多个线程可以同时回放同一个列表（共享的节点记录由各自的锁保护）
+ */
+class SDisplayList {
+public:
+    SDisplayList() = default;
+
+    SDisplayList(const SDisplayList&) = delete;
+    SDisplayList& operator=(const SDisplayList&) = delete;
+    SDisplayList(SDisplayList&&) = default;
+    SDisplayList& operator=(SDisplayList&&) = default;
+
+    // 记录命令
+    void save();
+    void restore();
+    void translate(double x, double y);
+    void clipRect(double x, double y, double width, double height);
+    void drawRecording(const SRecordingPtr& recording);
+
+    /**
+     * 在设备坐标(x, y)处贴图，增加表面的引用计数
+     * 表面在此刷新，加入列表后调用者不能再修改它
+     */
+    void drawSurface(cairo_surface_t* surface, double x, double y);
+
+    /**
+     * 回放到cr，cr的变换应为单位矩阵（设备坐标系）
+     */
+    void replay(cairo_t* cr) const;
+
+    /**
+     * 清空命令
+     */
+    void clear() { m_ops.clear(); }
+
+    size_t size() const { return m_ops.size(); }
+    bool empty() const { return m_ops.empty(); }
+    const std::vector<DisplayOp>& getOps() const { return m_ops; }
+
+private:
+    std::vector<DisplayOp> m_ops;
+};
+
+using SDisplayListPtr = std::shared_ptr<SDisplayList>;
+
+} // namespace sgui
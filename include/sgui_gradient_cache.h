@@ -0,0 +1,101 @@
+/**
+ * 渐变图案缓存
+ *
+ * 背景渐变按样式和绘制区域尺寸编译为cairo图案，相同的渐变（例如多个按钮使用的同一个预设）共享一个图案。
+ * 图案在区域局部坐标系(0, 0)-(width, height)中定义，使用前把用户坐标系平移到区域左上角。
+ */
+
+#pragma once
+
+#include <cairo/cairo.h>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include "sgui_common.h"
+
+namespace sgui {
+
+/**
+ * 渐变图案缓存统计信息
+ */
+struct GradientCacheStats {
+    size_t patternCount = 0; // 当前缓存的图案数
+    size_t capacity = 0;     // 最多缓存的图案数
+    uint64_t hits = 0;       // 直接使用缓存的次数
+    uint64_t misses = 0;     // 新建图案的次数
+    uint64_t evictions = 0;  // 因超出容量被淘汰的图案数
+};
+
+/**
+ * 渐变图案缓存类
+ *
+ * 全局共享，只能在主线程（渲染控件树的线程）使用。
+ * 返回的图案带有一个引用，被淘汰后仍然可以继续使用，直到调用者释放；图案创建后不再修改。
+ */
+class SGradientCache {
+public:
+    /**
+     * 默认最多缓存的图案数
+     */
+    static constexpr size_t kDefaultCapacity = 256;
+
+    /**
+     * 获取全局渐变图案缓存
+     */
+    static SGradientCache& instance();
+
+    SGradientCache() = default;
+    ~SGradientCache();
+
+    SGradientCache(const SGradientCache&) = delete;
+    SGradientCache& operator=(const SGradientCache&) = delete;
+
+    /**
+     * 获取渐变在width x height区域上的图案，没有缓存时编译
+     * @return 图案（调用者持有一个引用，需要cairo_pattern_destroy），渐变没有停止点时返回nullptr
+     */
+    cairo_pattern_t* acquire(const BackgroundGradient& gradient, double width, double height);
+
+    /**
+     * 编译渐变图案，不使用缓存
+     * 线性渐变按CSS的角度约定：0度从下到上，90度从左到右，顺时针增加，渐变线长度使区域的角正好落在两端；
+     * 径向渐变以区域中心为圆心，椭圆的长宽比与区域一致并经过区域的四个角
+     */
+    static cairo_pattern_t* create(const BackgroundGradient& gradient, double width, double height);
+
+    /**
+     * 设置最多缓存的图案数
+     */
+    void setCapacity(size_t capacity);
+    size_t getCapacity() const { return m_capacity; }
+
+    /**
+     * 获取统计信息
+     */
+    GradientCacheStats getStats() const;
+
+    /**
+     * 释放所有缓存的图案
+     */
+    void clear();
+
+private:
+    struct Slot {
+        cairo_pattern_t* pattern = nullptr;
+        std::list<std::string>::iterator lru;
+    };
+
+    static std::string makeKey(const BackgroundGradient& gradient, double width, double height);
+    void evict();
+
+    std::unordered_map<std::string, Slot> m_patterns;
+    std::list<std::string> m_lru; // 最近使用的在前
+    size_t m_capacity = kDefaultCapacity;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+    uint64_t m_evictions = 0;
+};
+
+} // namespace sgui
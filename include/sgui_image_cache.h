@@ -0,0 +1,226 @@
+/**
+ * 图像缓存
+ *
+ * 背景图片等按文件路径加载的图像解码后缓存为cairo图像表面，进程内所有控件和窗口共享。
+ * 缓存项记录文件的修改时间，文件被修改后下次获取时重新解码。
+ * 所有图像共享一个内存预算，超出预算时淘汰最久未使用的图像。
+ * 图像也可以在后台线程池异步解码：当前帧可见的图像优先解码，请求可以随时取消。
+ */
+
+#pragma once
+
+#include <cairo/cairo.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sgui {
+
+/**
+ * 图像缓存统计信息
+ */
+struct ImageCacheStats {
+    size_t imageCount = 0;  // 当前缓存的图像数
+    size_t bytes = 0;       // 当前占用的字节数
+    size_t budget = 0;      // 内存预算（字节）
+    uint64_t hits = 0;      // 直接使用缓存的次数
+    uint64_t misses = 0;    // 需要解码的次数（包括文件被修改后重新解码）
+    uint64_t evictions = 0; // 因超出预算被淘汰的图像数
+    uint64_t failures = 0;  // 加载失败的次数
+    uint64_t asyncRequests = 0;  // 异步解码请求数
+    uint64_t asyncCancelled = 0; // 解码开始前被取消的请求数
+    size_t asyncPending = 0;     // 等待解码的图像数
+};
+
+/**
+ * 异步解码优先级
+ */
+enum class ImageDecodePriority {
+    Prefetch = 0, // 预取：设置了图像但还没有绘制过
+    Visible = 1   // 当前帧可见：绘制时需要而还没有解码完成
+};
+
+/**
+ * 异步解码请求
+ *
+ * 同时也是取消令牌：cancel()之后完成回调不会再被调用。
+ * 完成回调只通过SThreadPool投递到UI线程执行，cancel()也应该在UI线程调用，因此两者不会同时进行；
+ * 没有设置投递函数时不调用完成回调，只能通过isDone()查询。
+ */
+class SImageRequest {
+public:
+    SImageRequest(const std::string& path, ImageDecodePriority priority, std::function<void()> onReady);
+    ~SImageRequest();
+
+    SImageRequest(const SImageRequest&) = delete;
+    SImageRequest& operator=(const SImageRequest&) = delete;
+
+    /**
+     * 取消请求；所有请求都被取消的图像不再解码
+     */
+    void cancel() { m_cancelled = true; }
+    bool isCancelled() const { return m_cancelled; }
+
+    /**
+     * 调整优先级，只影响还没有开始解码的请求
+     */
+    void setPriority(ImageDecodePriority priority) { m_priority = static_cast<int>(priority); }
+    ImageDecodePriority getPriority() const { return static_cast<ImageDecodePriority>(m_priority.load()); }
+
+    /**
+     * 解码是否已经结束（成功或失败）
+     */
+    bool isDone() const { return m_done.load(std::memory_order_acquire); }
+
+    /**
+     * 解码结果，请求持有一个引用；未完成或加载失败时为nullptr
+     */
+    cairo_surface_t* getSurface() const { return isDone() ? m_surface : nullptr; }
+
+    const std::string& getPath() const { return m_path; }
+
+private:
+    friend class SImageCache;
+
+    std::string m_path;
+    std::function<void()> m_onReady;
+    std::atomic<int> m_priority;
+    std::atomic<bool> m_cancelled{false};
+    std::atomic<bool> m_done{false};
+    cairo_surface_t* m_surface = nullptr;
+};
+
+using SImageRequestPtr = std::shared_ptr<SImageRequest>;
+
+/**
+ * 图像缓存类
+ *
+ * 全局共享，可以在任意线程使用。
+ * 返回的表面带有一个引用，被淘汰或替换后仍然可以继续使用，直到调用者释放。
+ */
+class SImageCache {
+public:
+    /**
+     * 默认内存预算
+     */
+    static constexpr size_t kDefaultBudget = 64 * 1024 * 1024;
+
+    /**
+     * 获取全局图像缓存
+     */
+    static SImageCache& instance();
+
+    SImageCache() = default;
+    ~SImageCache();
+
+    SImageCache(const SImageCache&) = delete;
+    SImageCache& operator=(const SImageCache&) = delete;
+
+    /**
+     * 获取路径对应的图像，没有缓存或文件已被修改时解码PNG文件
+     * @param path 图像文件路径
+     * @return 图像表面（调用者持有一个引用，需要cairo_surface_destroy），加载失败返回nullptr
+     */
+    cairo_surface_t* acquire(const std::string& path);
+
+    /**
+     * 只查找缓存，不解码
+     * @return 缓存的最新图像（调用者持有一个引用），没有缓存或文件已被修改时返回nullptr
+     */
+    cairo_surface_t* lookup(const std::string& path);
+
+    /**
+     * 在后台线程池异步解码图像
+     * 同一路径的多个请求合并为一次解码；每个工作任务总是取出优先级最高的等待图像，
+     * 同优先级按请求顺序
+     * @param path 图像文件路径
+     * @param priority 解码优先级
+     * @param onReady 解码结束（成功或失败）后在UI线程调用，请求被取消或者没有设置UI线程投递函数时不调用
+     * @return 请求，也用作取消令牌
+     */
+    SImageRequestPtr requestAsync(const std::string& path, ImageDecodePriority priority, std::function<void()> onReady);
+
+    /**
+     * 设置控件是否异步解码背景图像，默认启用
+     * 关闭时在绘制过程中同步解码，适合需要确定输出的离线渲染
+     */
+    void setAsyncDecode(bool enabled) { m_asyncDecode = enabled; }
+
+    /**
+     * 控件是否异步解码背景图像
+     * 没有设置UI线程投递函数（没有创建SWindowManager）时完成通知无法回到UI线程，总是同步解码
+     */
+    bool isAsyncDecode() const;
+
+    /**
+     * 设置内存预算（字节），超出时立即淘汰最久未使用的图像
+     */
+    void setBudget(size_t bytes);
+    size_t getBudget() const;
+
+    /**
+     * 获取统计信息
+     */
+    ImageCacheStats getStats() const;
+
+    /**
+     * 释放路径对应的缓存图像
+     */
+    void remove(const std::string& path);
+
+    /**
+     * 释放所有缓存图像
+     */
+    void clear();
+
+private:
+    struct Entry {
+        cairo_surface_t* surface = nullptr;
+        std::filesystem::file_time_type modified; // 解码时文件的修改时间
+        size_t bytes = 0;
+        std::list<std::string>::iterator lru;
+    };
+
+    struct PendingDecode {
+        std::vector<SImageRequestPtr> requests;
+        uint64_t sequence = 0; // 请求顺序，同优先级时先请求的先解码
+    };
+
+    cairo_surface_t* lookupLocked(const std::string& path, bool hasModified,
+                                  const std::filesystem::file_time_type& modified);
+    void removeLocked(const std::string& path);
+    void evictLocked();
+
+    /**
+     * 取出优先级最高的等待图像并解码（在工作线程执行）
+     * @return 等待该图像的请求
+     */
+    std::vector<SImageRequestPtr> decodeNext();
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_images;
+    std::list<std::string> m_lru; // 最近使用的在前
+    size_t m_budget = kDefaultBudget;
+    size_t m_bytes = 0;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+    uint64_t m_evictions = 0;
+    uint64_t m_failures = 0;
+
+    // 异步解码
+    std::atomic<bool> m_asyncDecode{true};
+    std::unordered_map<std::string, PendingDecode> m_pending;
+    uint64_t m_nextSequence = 0;
+    uint64_t m_asyncRequests = 0;
+    uint64_t m_asyncCancelled = 0;
+};
+
+} // namespace sgui
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "sgui_container.h"
+#include "sgui_timer.h"
 #include <functional>
 #include <string>
 #include <chrono>
@@ -120,22 +121,22 @@ public:
     // ====================================================================
     
     /** 设置占位符文本颜色 */
-    void setPlaceholderColor(const Color& color) { m_placeholderColor = color; markDirty(); }
+    void setPlaceholderColor(const Color& color) { m_placeholderColor = color; markPaintDirty(); }
     /** 获取占位符文本颜色 */
     const Color& getPlaceholderColor() const { return m_placeholderColor; }
     
     /** 设置光标颜色 */
-    void setCursorColor(const Color& color) { m_cursorColor = color; markDirty(); }
+    void setCursorColor(const Color& color) { m_cursorColor = color; markPaintDirty(); }
     /** 获取光标颜色 */
     const Color& getCursorColor() const { return m_cursorColor; }
     
     /** 设置选择高亮颜色 */
-    void setSelectionColor(const Color& color) { m_selectionColor = color; markDirty(); }
+    void setSelectionColor(const Color& color) { m_selectionColor = color; markPaintDirty(); }
     /** 获取选择高亮颜色 */
     const Color& getSelectionColor() const { return m_selectionColor; }
     
     /** 设置光标宽度 */
-    void setCursorWidth(float width) { m_cursorWidth = width; markDirty(); }
+    void setCursorWidth(float width) { m_cursorWidth = width; markPaintDirty(); }
     /** 获取光标宽度 */
     float getCursorWidth() const { return m_cursorWidth; }
     
@@ -256,8 +257,12 @@ private:
     /** 根据像素坐标获取字符位置 */
     int getCharIndexAt(float x) const;
     
-    /** 更新光标闪烁状态 */
+    /** 更新光标闪烁状态（没有定时器服务时在render中轮询） */
     void updateCursorBlink();
+
+    /** 启动或停止光标闪烁定时器 */
+    void startCursorBlink();
+    void stopCursorBlink();
     
     /** 添加到撤销历史 */
     void addToHistory();
@@ -306,6 +311,12 @@ private:
     
     /** 上次光标闪烁时间 */
     std::chrono::steady_clock::time_point m_lastBlinkTime;
+
+    /** 光标闪烁定时器，0表示未使用定时器 */
+    TimerId m_blinkTimer = 0;
+
+    /** 创建光标闪烁定时器的定时器服务，取消时使用同一个服务 */
+    STimerService *m_blinkTimerService = nullptr;
     
     // ====================================================================
     // 样式配置
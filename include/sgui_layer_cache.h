@@ -0,0 +1,132 @@
+/**
+ * 层缓存
+ *
+ * 被提升为"层"的节点把整棵子树渲染到一个缓存的图像表面中，
+ * 子树没有需要重绘的节点时直接把缓存贴到后缓冲，不再逐个节点重新光栅化。
+ * 所有层共享一个内存预算，超出预算时淘汰最久未使用的层。
+ */
+
+#pragma once
+
+#include <cairo/cairo.h>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+namespace sgui {
+
+class SLayout;
+
+/**
+ * 缓存的层
+ */
+struct LayerEntry {
+    cairo_surface_t* surface = nullptr; // 子树的渲染结果（ARGB32）
+    int offsetX = 0;        // 表面左上角相对节点原点所在整像素的偏移（设备像素）
+    int offsetY = 0;
+    double phaseX = 0.0;    // 渲染时节点原点的亚像素相位，相位不同时需要重新渲染
+    double phaseY = 0.0;
+    float nodeWidth = 0.0f; // 渲染时节点的布局尺寸
+    float nodeHeight = 0.0f;
+    size_t bytes = 0;       // 表面占用的字节数
+};
+
+/**
+ * 层缓存统计信息
+ */
+struct LayerCacheStats {
+    size_t layerCount = 0;  // 当前缓存的层数
+    size_t bytes = 0;       // 当前占用的字节数
+    size_t budget = 0;      // 内存预算（字节）
+    uint64_t hits = 0;      // 直接使用缓存的次数
+    uint64_t renders = 0;   // 重新渲染层的次数
+    uint64_t evictions = 0; // 因超出预算被淘汰的层数
+    uint64_t rejected = 0;  // 单层超过预算而没有缓存的次数
+};
+
+/**
+ * 层缓存类
+ *
+ * 全局共享，只能在主线程（渲染控件树的线程）使用。
+ * 层表面创建后不再修改，重新渲染时总是创建新表面，
+ * 因此已经提交给渲染线程的帧快照可以安全地引用旧表面。
+ */
+class SLayerCache {
+public:
+    /**
+     * 默认内存预算
+     */
+    static constexpr size_t kDefaultBudget = 64 * 1024 * 1024;
+
+    /**
+     * 获取全局层缓存
+     */
+    static SLayerCache& instance();
+
+    SLayerCache() = default;
+    ~SLayerCache();
+
+    SLayerCache(const SLayerCache&) = delete;
+    SLayerCache& operator=(const SLayerCache&) = delete;
+
+    /**
+     * 设置内存预算（字节），超出时立即淘汰最久未使用的层
+     */
+    void setBudget(size_t bytes);
+    size_t getBudget() const { return m_budget; }
+
+    /**
+     * 获取统计信息
+     */
+    LayerCacheStats getStats() const;
+
+    /**
+     * 释放所有层
+     */
+    void clear();
+
+    // ====================================================================
+    // 以下由SLayout调用
+    // ====================================================================
+
+    /**
+     * 查找节点的层，不更新使用顺序
+     */
+    const LayerEntry* find(const SLayout* owner) const;
+
+    /**
+     * 记录一次缓存命中并把层移到最近使用
+     */
+    void touch(const SLayout* owner);
+
+    /**
+     * 保存节点新渲染的层，替换旧的层，缓存接管表面的所有权
+     * @return 层超过整个预算时不缓存（表面被释放）并返回false
+     */
+    bool store(const SLayout* owner, const LayerEntry& entry);
+
+    /**
+     * 释放节点的层
+     */
+    void remove(const SLayout* owner);
+
+private:
+    struct Slot {
+        LayerEntry entry;
+        std::list<const SLayout*>::iterator lru;
+    };
+
+    void evict();
+
+    std::unordered_map<const SLayout*, Slot> m_layers;
+    std::list<const SLayout*> m_lru; // 最近使用的在前
+    size_t m_budget = kDefaultBudget;
+    size_t m_bytes = 0;
+    uint64_t m_hits = 0;
+    uint64_t m_renders = 0;
+    uint64_t m_evictions = 0;
+    uint64_t m_rejected = 0;
+};
+
+} // namespace sgui
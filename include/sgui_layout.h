@@ -17,6 +17,7 @@
 #include <memory>
 #include <functional>
 #include "sgui_common.h"
+#include "sgui_display_list.h"
 #include <cairo/cairo.h>
 
 namespace sgui {
@@ -28,6 +29,14 @@ class SLayout;
 using SLayoutPtr = std::shared_ptr<SLayout>;
 using SLayoutWeakPtr = std::weak_ptr<SLayout>;
 
+/**
+ * 渲染统计信息（最近一次renderTree/recordDisplayList）
+ */
+struct RenderStats {
+    size_t paintedNodes = 0; // 绘制（或作为层贴图）的节点数
+    size_t culledNodes = 0;  // 因为在裁剪范围或损坏区域之外而跳过的节点数
+};
+
 /**
  * Container基类 - 所有GUI组件的基础
  */
@@ -387,6 +396,16 @@ public:
      */
     float getLayoutWidth() const;
     float getLayoutHeight() const;
+
+    /**
+     * 获取相对于根节点的绝对位置（累加所有祖先的布局位置）
+     */
+    void getAbsolutePosition(float& x, float& y) const;
+
+    /**
+     * 获取根节点
+     */
+    const SLayout* getRoot() const;
     
     /**
      * 获取计算后的边距
@@ -413,19 +432,56 @@ public:
     float getLayoutBorderBottom() const;
     
     /**
-     * 检查布局是否需要重新计算
+     * 检查子树是否需要重新计算布局或重绘
      */
     bool isDirty() const;
     
     /**
-     * 标记需要重新计算布局
+     * 标记需要重新计算布局（等同于markLayoutDirty）
      */
     void markDirty();
 
     /**
-     * 清除dirty标记
+     * 清除子树的布局和重绘标记
      */
     void clearDirty();
+
+    /**
+     * 标记需要重新计算布局
+     * 同时标记需要重绘，并向上传播到根节点
+     */
+    void markLayoutDirty();
+
+    /**
+     * 标记需要重绘（不需要重新计算布局），并向上传播到根节点
+     * 只影响外观的属性（颜色、控件状态等）使用该函数，避免触发Yoga布局计算
+     */
+    void markPaintDirty();
+
+    /**
+     * 子树中是否有节点需要重新计算布局
+     */
+    bool isLayoutDirty() const { return m_layoutDirty; }
+
+    /**
+     * 节点自身是否需要重绘
+     */
+    bool isPaintDirty() const { return m_paintDirty; }
+
+    /**
+     * 子树中是否有节点需要重绘
+     */
+    bool isSubtreePaintDirty() const { return m_subtreePaintDirty; }
+
+    /**
+     * 清除子树的布局标记
+     */
+    void clearLayoutDirty();
+
+    /**
+     * 清除子树的重绘标记
+     */
+    void clearPaintDirty();
     
     // ====================================================================
     // 虚函数接口
@@ -451,16 +507,103 @@ public:
         (void)measuredHeight;
     }
     
+    /**
+     * 绘制不受自身溢出裁剪影响的内容（例如外阴影），在render之前调用
+     * 与render的输出一起记录在节点的绘制记录中
+     */
+    virtual void renderOutset(cairo_t* cr) {}
+
+    /**
+     * 节点绘制内容的范围（节点坐标系），默认为节点自身的边界
+     * 绘制到边界以外的节点（例如阴影）需要重写，用于损坏区域、可见性剔除和层的尺寸；
+     * 结果变化时调用invalidatePaintBounds()
+     */
+    virtual Rect getPaintBounds() const;
+
     /**
      * 布局变化回调
      */
     virtual void onLayoutChanged() {}
+
+    /**
+     * 节点所在的子树从父节点移除后调用（对子树中的每个节点）
+     * 子类在这里取消还没有完成的后台任务，例如异步图像解码
+     */
+    virtual void onDetached() {}
     
     /**
      * 渲染容器及其所有子节点
+     * 遍历时按cr当前的裁剪范围剔除节点：自身边界在裁剪范围之外的节点跳过render，
+     * 子树范围在裁剪范围之外的节点跳过整棵子树
      * @param cr Cairo绘制上下文
      */
     void renderTree(cairo_t* cr);
+
+    /**
+     * 只重绘与损坏区域相交的节点
+     * 调用者需要先把cr裁剪到损坏区域；除了按裁剪范围剔除，自身边界与区域不相交的节点跳过render，
+     * 子树范围与区域不相交的节点跳过整棵子树
+     * @param cr Cairo绘制上下文
+     * @param damage 损坏区域（窗口坐标）
+     */
+    void renderTree(cairo_t* cr, const cairo_region_t* damage);
+
+    /**
+     * 把控件树记录为帧显示列表
+     * 节点的render()输出按节点缓存为绘制记录，没有变化的节点直接复用；
+     * 列表从单位矩阵开始回放，可以在其他线程回放
+     * @param list 输出的显示列表（追加）
+     * @param antialias 回放目标使用的抗锯齿模式
+     */
+    void recordDisplayList(SDisplayList& list, cairo_antialias_t antialias = CAIRO_ANTIALIAS_DEFAULT);
+
+    /**
+     * 把控件树中与裁剪矩形相交的部分记录为帧显示列表
+     * @param clip 裁剪矩形（设备坐标），通常是窗口或损坏区域的范围
+     */
+    void recordDisplayList(SDisplayList& list, cairo_antialias_t antialias, const Rect& clip);
+
+    /**
+     * getPaintBounds()的结果变化后调用：节点需要重绘，缓存的子树范围失效
+     */
+    void invalidatePaintBounds();
+
+    /**
+     * 获取最近一次从本节点开始的renderTree/recordDisplayList的统计信息
+     */
+    const RenderStats& getRenderStats() const { return m_renderStats; }
+
+    /**
+     * 获取节点自身的绘制记录（节点坐标系），节点需要重绘时重新记录
+     * @param antialias 记录时使用的抗锯齿模式
+     */
+    const SRecordingPtr& getRecording(cairo_antialias_t antialias);
+
+    /**
+     * 设置层模式
+     * 作为层的节点把整棵子树渲染到缓存的图像表面，子树没有变化时直接贴图；
+     * 没有裁剪溢出时层覆盖所有子孙节点的范围
+     */
+    void setLayerMode(LayerMode mode);
+
+    /**
+     * 获取层模式
+     */
+    LayerMode getLayerMode() const { return m_layerMode; }
+
+    /**
+     * 节点当前是否有缓存的层
+     */
+    bool hasLayer() const;
+
+    /**
+     * 收集子树的损坏区域（窗口坐标）
+     * 需要重绘或者位置尺寸发生变化的节点，把上次绘制时的边界和新的边界加入区域，
+     * 并记录新的边界作为下一帧的比较基准
+     * @param damage 输出的损坏区域
+     * @param force 为true时遍历整棵子树比较边界（布局重新计算后节点可能移动）
+     */
+    void collectDamage(cairo_region_t* damage, bool force = false);
     
     // ====================================================================
     // 工具函数
@@ -509,8 +652,45 @@ protected:
 
     /**
      * Dirty 标记
+     * m_layoutDirty和m_subtreePaintDirty会向上传播，根节点的标记反映整棵树的状态
+     */
+    bool m_layoutDirty = true;       // 子树需要重新计算布局
+    bool m_paintDirty = true;        // 节点自身需要重绘
+    bool m_subtreePaintDirty = true; // 节点自身或子孙需要重绘
+
+    /**
+     * 损坏区域跟踪
+     */
+    Rect m_paintedBounds;              // 上次绘制时的绝对边界（窗口坐标）
+    bool m_hasPaintedBounds = false;   // 是否已经绘制过
+    std::vector<Rect> m_removedDamage; // 被移除子树上次绘制的边界，下次收集时加入损坏区域
+
+    /**
+     * 节点绘制记录
+     */
+    SRecordingPtr m_recording;
+    bool m_recordingValid = false;      // 记录是否反映了节点当前的外观
+    float m_recordingWidth = 0.0f;      // 记录时节点的布局尺寸
+    float m_recordingHeight = 0.0f;
+    cairo_antialias_t m_recordingAntialias = CAIRO_ANTIALIAS_DEFAULT;
+
+    /**
+     * 层缓存
+     */
+    LayerMode m_layerMode = LayerMode::Auto;
+    bool m_layerValid = false;       // 缓存的层是否反映了最近一次渲染的子树
+    int m_cleanFrames = 0;           // 子树连续没有需要重绘节点的帧数
+    uint64_t m_cleanFrameNumber = 0; // 最近一次统计m_cleanFrames时的绘制帧号
+    double m_paintCostUs = 0.0;      // 最近一次完整绘制或记录子树的耗时（微秒）
+
+    /**
+     * 可见性剔除
+     * 子树范围在布局变化后重新计算，用布局版本号判断缓存是否有效
      */
-    bool m_dirty = true;
+    Rect m_subtreeBounds;                // 子树在节点坐标系中的范围
+    size_t m_subtreeCount = 0;           // 子树中显示的节点数（包括自身）
+    uint64_t m_subtreeBoundsVersion = 0; // 计算范围时的布局版本号，0表示未计算
+    RenderStats m_renderStats;
 
 private:
     /**
@@ -539,6 +719,68 @@ private:
      * 位置设置辅助函数
      */
     void setPositionValues(const EdgeInsets& position);
+
+    /**
+     * 损坏区域收集的递归实现
+     * @param parentX/parentY 父节点的绝对位置
+     * @param hidden 祖先节点不显示
+     */
+    void collectDamageImpl(cairo_region_t* damage, float parentX, float parentY, bool force, bool hidden);
+
+    /**
+     * 渲染递归实现
+     * @param damage 损坏区域，为nullptr时绘制所有节点
+     * @param originX/originY 父节点的绝对位置
+     * @param allowLayer 是否允许使用本节点的层（渲染层内容时为false）
+     * @param stats 累加绘制和剔除的节点数
+     * @return 绘制的节点数
+     */
+    size_t renderTreeImpl(cairo_t* cr, const cairo_region_t* damage, float originX, float originY, bool allowLayer,
+                          RenderStats& stats);
+
+    /**
+     * 本帧是否把节点作为层绘制
+     */
+    bool shouldUseLayer();
+
+    /**
+     * 显示列表记录的递归实现
+     * @param deviceX/deviceY 父节点坐标系原点的设备坐标
+     * @param clip 当前的裁剪矩形（设备坐标），为nullptr时不剔除
+     */
+    void recordDisplayListImpl(SDisplayList& list, double deviceX, double deviceY, cairo_antialias_t antialias,
+                               const Rect* clip, RenderStats& stats);
+
+    /**
+     * 获取节点的层表面，层无效时先重新渲染
+     * @param deviceX/deviceY 节点原点的设备坐标
+     * @param x/y 输出层表面左上角的设备坐标
+     * @return 层表面（调用者持有一个引用，需要cairo_surface_destroy），失败返回nullptr
+     */
+    cairo_surface_t* acquireLayer(double deviceX, double deviceY, cairo_antialias_t antialias, double& x, double& y);
+
+    /**
+     * 绘制节点的层，层无效时先重新渲染
+     * @param left/top 节点在父节点坐标系中的位置
+     * @return 当前变换不是纯平移等无法使用层的情况返回false，由调用者直接绘制
+     */
+    bool drawLayer(cairo_t* cr, float left, float top);
+
+    /**
+     * 获取子树在节点坐标系中的范围（裁剪溢出的子孙只计算到其自身边界）
+     * 结果按布局版本号缓存，布局没有变化时不再遍历子树
+     */
+    const Rect& getSubtreeBounds();
+
+    /**
+     * 取出子树上次绘制的边界（节点被移除时调用），并重置绘制状态
+     */
+    void takePaintedBounds(std::vector<Rect>& out);
+
+    /**
+     * 对子树中的每个节点调用onDetached
+     */
+    void notifyDetached();
 };
 
 } // namespace sgui
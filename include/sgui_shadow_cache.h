@@ -0,0 +1,128 @@
+/**
+ * 阴影遮罩缓存
+ *
+ * 盒子阴影按形状（模糊半径、圆角半径、内外阴影）生成一次模糊后的A8遮罩，保存为九宫格：
+ * 四个角按原尺寸绘制，四条边和中心只有1像素宽，绘制时拉伸到目标尺寸。
+ * 调整节点大小只改变拉伸比例，不需要重新模糊；颜色在绘制时作为源指定，不同颜色的阴影共享遮罩。
+ */
+
+#pragma once
+
+#include <cairo/cairo.h>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+namespace sgui {
+
+/**
+ * 阴影形状
+ * 外阴影为扩散后的盒子，内阴影为收缩后的"洞"，洞以外的区域被阴影覆盖
+ */
+struct ShadowShape {
+    double width = 0.0;  // 形状尺寸
+    double height = 0.0;
+    double radiusTopLeft = 0.0; // 圆角半径
+    double radiusTopRight = 0.0;
+    double radiusBottomRight = 0.0;
+    double radiusBottomLeft = 0.0;
+    double blurRadius = 0.0; // 模糊半径（CSS约定，高斯标准差的2倍）
+    bool inset = false;      // 是否为内阴影
+};
+
+/**
+ * 阴影遮罩缓存统计信息
+ */
+struct ShadowCacheStats {
+    size_t maskCount = 0;   // 当前缓存的遮罩数
+    size_t bytes = 0;       // 当前占用的字节数
+    size_t budget = 0;      // 内存预算（字节）
+    uint64_t hits = 0;      // 直接使用缓存的次数
+    uint64_t blurs = 0;     // 生成并模糊遮罩的次数
+    uint64_t evictions = 0; // 因超出预算被淘汰的遮罩数
+};
+
+/**
+ * 阴影遮罩缓存类
+ *
+ * 全局共享，只能在主线程（渲染控件树的线程）使用。遮罩创建后不再修改。
+ */
+class SShadowCache {
+public:
+    /**
+     * 默认内存预算
+     */
+    static constexpr size_t kDefaultBudget = 16 * 1024 * 1024;
+
+    /**
+     * 获取全局阴影遮罩缓存
+     */
+    static SShadowCache& instance();
+
+    SShadowCache() = default;
+    ~SShadowCache();
+
+    SShadowCache(const SShadowCache&) = delete;
+    SShadowCache& operator=(const SShadowCache&) = delete;
+
+    /**
+     * 模糊后阴影超出形状边缘的距离（像素）
+     */
+    static int blurExtent(double blurRadius);
+
+    /**
+     * 在cr的(x, y)处绘制形状的阴影，使用cr当前的源作为阴影颜色
+     * 只负责遮罩，外阴影排除盒子内部、内阴影限制在盒子内部的裁剪由调用者设置
+     */
+    void draw(cairo_t* cr, const ShadowShape& shape, double x, double y);
+
+    /**
+     * 设置内存预算（字节），超出时立即淘汰最久未使用的遮罩
+     */
+    void setBudget(size_t bytes);
+    size_t getBudget() const { return m_budget; }
+
+    /**
+     * 获取统计信息
+     */
+    ShadowCacheStats getStats() const;
+
+    /**
+     * 释放所有遮罩
+     */
+    void clear();
+
+private:
+    /**
+     * 模糊后的遮罩，按(sliceLeft, 中间, sliceRight) x (sliceTop, 中间, sliceBottom)划分为九宫格
+     */
+    struct Mask {
+        cairo_surface_t* surface = nullptr; // CAIRO_FORMAT_A8
+        int width = 0;
+        int height = 0;
+        int sliceLeft = 0;
+        int sliceTop = 0;
+        int sliceRight = 0;
+        int sliceBottom = 0;
+        bool exact = false; // 按目标尺寸生成，中间部分不拉伸
+        size_t bytes = 0;
+        std::list<std::string>::iterator lru;
+    };
+
+    const Mask& acquire(const ShadowShape& shape);
+    static Mask createMask(const ShadowShape& shape, bool exact);
+    void remove(const std::string& key);
+    void evict();
+
+    std::unordered_map<std::string, Mask> m_masks;
+    std::list<std::string> m_lru; // 最近使用的在前
+    size_t m_budget = kDefaultBudget;
+    size_t m_bytes = 0;
+    uint64_t m_hits = 0;
+    uint64_t m_blurs = 0;
+    uint64_t m_evictions = 0;
+};
+
+} // namespace sgui
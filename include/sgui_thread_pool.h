@@ -0,0 +1,206 @@
+/**
+ * 后台线程池
+ *
+ * 库级别的工作窃取线程池，控件和应用可以把耗时任务（图片解码、文本测量、数据处理等）
+ * 提交到后台执行，完成回调通过主循环投递回UI线程
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace sgui {
+
+/**
+ * 工作窃取线程池类
+ *
+ * 每个工作线程有自己的任务队列：工作线程提交的任务放入自己的队列并按后进先出执行，
+ * 外部线程提交的任务轮流分配到各队列；线程空闲时从其他队列的头部窃取任务。
+ */
+class SThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    /** 完成回调投递函数，负责把回调送到UI线程执行 */
+    using CompletionDispatcher = std::function<void(Task)>;
+
+    /** 错误回调，参数为任务抛出的异常 */
+    using ErrorHandler = std::function<void(std::exception_ptr)>;
+
+    /**
+     * 构造函数
+     * @param threadCount 线程数，0表示使用硬件并发数
+     */
+    explicit SThreadPool(size_t threadCount = 0);
+
+    /**
+     * 析构函数
+     * 执行完所有已提交的任务后退出工作线程
+     */
+    ~SThreadPool();
+
+    SThreadPool(const SThreadPool&) = delete;
+    SThreadPool& operator=(const SThreadPool&) = delete;
+
+    /**
+     * 获取库级别的共享线程池（首次使用时创建）
+     */
+    static SThreadPool& instance();
+
+    /**
+     * 获取已经创建的共享线程池
+     * @return 还没有创建时返回nullptr，不会因此创建线程池
+     */
+    static SThreadPool* existingInstance();
+
+    /**
+     * 设置共享线程池的线程数
+     * @param threadCount 线程数，0表示使用硬件并发数
+     *
+     * 会等待已提交的任务执行完毕，不能在线程池的任务中调用；
+     * 重新创建队列期间其他线程的提交会被阻塞，不会丢失
+     */
+    static void configure(size_t threadCount);
+
+    /**
+     * 设置完成回调投递函数（SWindowManager创建时设置为Post）
+     * @param dispatcher 为空时完成回调直接在工作线程执行
+     */
+    static void setCompletionDispatcher(CompletionDispatcher dispatcher);
+
+    /**
+     * 是否设置了完成回调投递函数，没有设置时submit的完成回调在工作线程执行
+     */
+    static bool hasCompletionDispatcher();
+
+    /**
+     * 把回调投递到UI线程
+     * @return 没有设置投递函数时返回false，回调不会被执行
+     */
+    static bool postCompletion(Task completion);
+
+    /**
+     * 提交任务
+     * @param job 任务函数
+     * @return 任务结果的future
+     */
+    template <typename F>
+    auto submit(F&& job) -> std::future<decltype(job())>
+    {
+        using Result = decltype(job());
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+        auto future = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return future;
+    }
+
+    /**
+     * 提交任务并在UI线程接收结果
+     * @param job 任务函数，在工作线程执行
+     * @param completion 完成回调，参数为任务结果（任务无返回值时无参数），在UI线程执行
+     * @param onError 错误回调，任务抛出异常时代替完成回调在UI线程执行；
+     *                为空时异常被记录到标准错误输出后丢弃，不会终止工作线程
+     */
+    template <typename F, typename C>
+    void submit(F&& job, C&& completion, ErrorHandler onError = nullptr)
+    {
+        using Result = decltype(job());
+        enqueue([job = std::forward<F>(job), completion = std::forward<C>(completion), onError = std::move(onError)]() mutable {
+            // 只捕获任务本身的异常，完成回调的异常不属于任务
+            if constexpr (std::is_void<Result>::value) {
+                try {
+                    job();
+                } catch (...) {
+                    dispatchError(std::current_exception(), std::move(onError));
+                    return;
+                }
+                dispatchCompletion(std::move(completion));
+            } else {
+                std::shared_ptr<Result> result;
+                try {
+                    result = std::make_shared<Result>(job());
+                } catch (...) {
+                    dispatchError(std::current_exception(), std::move(onError));
+                    return;
+                }
+                dispatchCompletion([completion = std::move(completion), result]() mutable { completion(std::move(*result)); });
+            }
+        });
+    }
+
+    /**
+     * 获取工作线程数
+     */
+    size_t getThreadCount() const { return m_workers.size(); }
+
+    /**
+     * 当前线程是否是本线程池的工作线程
+     */
+    bool isWorkerThread() const;
+
+    /**
+     * 是否所有已提交的任务都已执行完毕（包括正在执行的任务）
+     */
+    bool isIdle() const { return m_outstanding.load(std::memory_order_acquire) == 0; }
+
+    /**
+     * 等待所有已提交的任务执行完毕，最多等待timeout
+     * @return 线程池空闲时返回true
+     *
+     * 不能在线程池的任务中调用
+     */
+    template <typename Rep, typename Period>
+    bool waitIdleFor(const std::chrono::duration<Rep, Period>& timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_idleMutex);
+        return m_idleCv.wait_for(lock, timeout, [this] { return isIdle(); });
+    }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void start(size_t threadCount);
+    void stop();
+    void enqueue(Task task);
+    bool popTask(size_t index, Task& task);
+    void workerMain(size_t index);
+
+    static void dispatchCompletion(Task completion);
+    static void dispatchError(std::exception_ptr error, ErrorHandler onError);
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::thread> m_workers;
+
+    // 提交任务时共享持有，重新创建队列时独占持有
+    std::shared_mutex m_queuesMutex;
+
+    // 空闲线程在此等待；任务入队后才增加计数，窃取先于计数时计数可能暂时为负
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleepCv;
+    std::atomic<std::ptrdiff_t> m_pending{0};
+    std::atomic<size_t> m_nextQueue{0};
+    bool m_stopping = false;
+
+    // 已提交但还没有执行完的任务数，入队前增加、执行完后减少；归零时通知waitIdleFor
+    std::atomic<size_t> m_outstanding{0};
+    std::mutex m_idleMutex;
+    std::condition_variable m_idleCv;
+};
+
+} // namespace sgui
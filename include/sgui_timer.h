@@ -0,0 +1,171 @@
+/**
+ * 定时器服务
+ *
+ * 提供一次性定时器、重复定时器和动画帧回调，由SWindowManager持有并在主循环中驱动。
+ * 定时器存放在分层时间轮中，主循环根据最近的到期时间设置glfwWaitEventsTimeout，
+ * 定时任务不再需要持续重绘来轮询。
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace sgui {
+
+/** 定时器ID，0表示无效 */
+using TimerId = uint64_t;
+
+/** 定时器回调 */
+using TimerCallback = std::function<void()>;
+
+/** 动画帧回调，参数为本帧的时间戳 */
+using AnimationFrameCallback = std::function<void(std::chrono::steady_clock::time_point)>;
+
+/**
+ * 定时器服务类
+ *
+ * 使用4层、每层64个槽、精度1ms的分层时间轮。
+ * 只能在主线程（UI线程）使用，其他线程请通过SWindowManager::Post投递。
+ * 定时器ID在进程内所有定时器服务之间唯一，用过期的ID取消定时器不会影响其他定时器。
+ */
+class STimerService {
+public:
+    using Clock = std::chrono::steady_clock;
+    using ClockFunction = std::function<Clock::time_point()>;
+
+    /**
+     * 构造函数
+     * @param clock 时间来源，为空时使用steady_clock
+     */
+    explicit STimerService(ClockFunction clock = nullptr);
+    ~STimerService();
+
+    STimerService(const STimerService&) = delete;
+    STimerService& operator=(const STimerService&) = delete;
+
+    /**
+     * 获取当前窗口管理器持有的定时器服务
+     * @return 没有窗口管理器时返回nullptr
+     */
+    static STimerService* current();
+
+    /**
+     * 设置为当前定时器服务（由SWindowManager调用）
+     */
+    static void setCurrent(STimerService* service);
+
+    /**
+     * 定时器服务是否还存在
+     * 控件保存创建定时器的服务，取消前用它判断服务（窗口管理器）是否已经销毁
+     */
+    static bool isAlive(const STimerService* service);
+
+    /**
+     * 设置一次性定时器
+     * @param delayMs 延迟（毫秒）
+     * @param callback 回调
+     * @return 定时器ID
+     */
+    TimerId setTimeout(uint32_t delayMs, TimerCallback callback);
+
+    /**
+     * 设置重复定时器
+     * @param intervalMs 间隔（毫秒），最小为1
+     * @param callback 回调
+     * @return 定时器ID
+     */
+    TimerId setInterval(uint32_t intervalMs, TimerCallback callback);
+
+    /**
+     * 取消定时器，可以在回调中调用
+     */
+    void clearTimer(TimerId id);
+
+    /**
+     * 请求在下一帧渲染前执行回调
+     * @return 回调ID
+     */
+    TimerId requestAnimationFrame(AnimationFrameCallback callback);
+
+    /**
+     * 取消动画帧回调
+     */
+    void cancelAnimationFrame(TimerId id);
+
+    /**
+     * 获取时间来源的当前时间
+     */
+    Clock::time_point now() const;
+
+    /**
+     * 推进时间轮到当前时间并执行所有到期的定时器
+     * @return 执行的回调数
+     */
+    size_t advance();
+
+    /**
+     * 执行所有已请求的动画帧回调
+     * @param frameTime 本帧时间戳
+     * @return 执行的回调数
+     *
+     * 回调中再次请求的动画帧回调留到下一帧执行
+     */
+    size_t runAnimationFrames(Clock::time_point frameTime);
+
+    /** 是否有等待执行的动画帧回调 */
+    bool hasAnimationFrameRequests() const { return !m_frameCallbacks.empty(); }
+
+    /** 是否有活动的定时器 */
+    bool hasTimers() const { return !m_timers.empty(); }
+
+    /** 是否有活动的一次性定时器（不包括重复定时器） */
+    bool hasOneShotTimers() const;
+
+    /**
+     * 获取下一次需要推进时间轮的时间
+     * @param deadline 输出时间点
+     * @return 没有定时器时返回false
+     *
+     * 对于较高层的定时器返回其降级到低层的时间，不早于真正的到期时间
+     */
+    bool nextDeadline(Clock::time_point& deadline) const;
+
+private:
+    static constexpr int kLevels = 4;
+    static constexpr int kSlotBits = 6;
+    static constexpr int kSlots = 1 << kSlotBits;
+    static constexpr uint64_t kSlotMask = kSlots - 1;
+
+    struct Timer {
+        uint64_t expireTick = 0;
+        uint32_t intervalMs = 0; // 0表示一次性定时器
+        TimerCallback callback;
+    };
+
+    struct Level {
+        std::array<std::vector<TimerId>, kSlots> slots;
+        uint64_t occupied = 0; // 非空槽位图
+    };
+
+    uint64_t toTick(Clock::time_point time) const;
+    Clock::time_point fromTick(uint64_t tick) const;
+    void insert(TimerId id, uint64_t expireTick);
+    void cascade(int level, uint64_t tick);
+    size_t expire(uint64_t tick);
+
+    ClockFunction m_clock;
+    Clock::time_point m_start;
+    uint64_t m_currentTick = 0;
+
+    std::array<Level, kLevels> m_levels;
+    std::unordered_map<TimerId, Timer> m_timers;
+
+    std::vector<std::pair<TimerId, AnimationFrameCallback>> m_frameCallbacks;
+};
+
+} // namespace sgui
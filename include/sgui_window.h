@@ -4,7 +4,17 @@
 #include <memory>
 #include <vector>
 #include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <map>
+#include <array>
+#include <string>
+#include <cairo/cairo.h>
 #include "sgui_common.h"
+#include "sgui_display_list.h"
 #include <GLFW/glfw3.h>
 
 // 前向声明
@@ -12,8 +22,130 @@ namespace sgui {
     class SCairoRenderer;
     class SContainer;
     class SWindowManager;
+    class SRenderThread;
+    class STaskQueue;
+    class STimerService;
 }
 
+namespace sgui {
+
+/**
+ * @brief 主循环运行模式
+ */
+enum class LoopMode
+{
+    Continuous,  // 连续模式：每次循环重绘所有窗口（默认）
+    EventDriven  // 事件驱动模式：阻塞等待事件，只重绘失效的窗口
+};
+
+/**
+ * @brief 窗口后端
+ */
+enum class WindowBackend
+{
+    Glfw,     // 使用GLFW创建真实窗口（默认）
+    Headless  // 无窗口：渲染到内存中的图像表面，输入通过Inject*注入，主循环使用虚拟时钟
+};
+
+/**
+ * @brief 主循环统计信息
+ *
+ * 用于确认空闲时主循环没有多余的唤醒和重绘
+ */
+struct LoopStats
+{
+    double wakeupsPerSecond = 0.0; // 最近一个统计周期（1秒）内的唤醒次数
+    uint64_t totalWakeups = 0;     // 累计唤醒次数
+    uint64_t framesRendered = 0;   // 累计渲染的窗口帧数
+    uint64_t framesSkipped = 0;    // 累计跳过的窗口帧数（窗口没有失效内容）
+    uint64_t tasksExecuted = 0;    // 累计执行的投递任务数
+    uint64_t timersFired = 0;      // 累计执行的定时器回调数
+    uint64_t animationFrames = 0;  // 累计执行的动画帧回调数
+    uint64_t idleCallbacks = 0;    // 累计执行的空闲回调数
+};
+
+/**
+ * @brief 窗口帧统计信息
+ *
+ * 由帧调度器在每一帧渲染前后更新
+ */
+struct FrameStats
+{
+    std::chrono::steady_clock::time_point lastFrameStart; // 最近一帧的开始时间
+    std::chrono::steady_clock::time_point lastFrameEnd;   // 最近一帧的结束时间
+    uint64_t frameCount = 0;      // 已渲染的帧数
+    uint64_t missedDeadlines = 0; // 结束时间超过帧截止时间的帧数
+    uint64_t droppedFrames = 0;   // 因落后于节奏而直接丢弃的过时帧数
+    uint64_t lastDamageArea = 0;  // 最近一帧重绘的损坏区域面积（像素）
+    uint64_t lastPresentedBytes = 0; // 最近一帧呈现到窗口的字节数（渲染线程模式下不统计）
+    uint64_t lastPaintedNodes = 0;   // 最近一帧绘制的节点数
+    uint64_t lastCulledNodes = 0;    // 最近一帧因不可见而跳过的节点数
+};
+
+/**
+ * @brief 输入到呈现的延迟直方图
+ *
+ * 按微秒的以2为底的对数分桶：第i个桶统计[2^i, 2^(i+1))微秒的样本
+ */
+struct LatencyHistogram
+{
+    static constexpr size_t kBucketCount = 32;
+
+    std::array<uint64_t, kBucketCount> buckets{}; // 各桶的样本数
+    uint64_t count = 0;   // 样本总数
+    uint64_t totalUs = 0; // 延迟总和（微秒）
+    uint64_t maxUs = 0;   // 最大延迟（微秒）
+
+    /**
+     * @brief 记录一个样本
+     */
+    void record(std::chrono::steady_clock::duration latency);
+
+    /**
+     * @brief 估算百分位延迟（微秒）
+     * @param p 百分位，取值0-100
+     * @return 样本所在桶的上界，没有样本时返回0
+     */
+    double percentileUs(double p) const;
+
+    /**
+     * @brief 平均延迟（微秒）
+     */
+    double meanUs() const { return count ? static_cast<double>(totalUs) / count : 0.0; }
+};
+
+/**
+ * @brief 空闲回调的截止时间
+ *
+ * 空闲回调应当在timeRemaining()耗尽前返回，剩余的工作可以重新请求空闲回调
+ */
+class IdleDeadline
+{
+public:
+    IdleDeadline(const SWindowManager* manager, std::chrono::steady_clock::time_point deadline, bool didTimeout)
+        : manager_(manager), deadline_(deadline), didTimeout_(didTimeout) {}
+
+    /**
+     * @brief 获取本次空闲时段的剩余时间（毫秒），不小于0
+     */
+    double timeRemaining() const;
+
+    /**
+     * @brief 回调是否因为超时而被强制执行（此时可能没有剩余时间）
+     */
+    bool didTimeout() const { return didTimeout_; }
+
+private:
+    const SWindowManager* manager_;
+    std::chrono::steady_clock::time_point deadline_;
+    bool didTimeout_;
+};
+
+/** 空闲回调类型 */
+using IdleCallback = std::function<void(const IdleDeadline&)>;
+
+} // namespace sgui
+
 /**
  * @class SWindow
  * @brief 使用简化Cairo渲染器的窗口类
@@ -54,12 +186,168 @@ public:
      */
     void Render();
 
+    /**
+     * @brief 标记窗口需要重绘
+     *
+     * 事件驱动模式下只有被标记的窗口（或控件树变脏的窗口）才会重绘
+     */
+    void Invalidate();
+
+    /**
+     * @brief 检查窗口是否需要重绘
+     * @return 窗口被标记失效或根容器变脏时返回true
+     */
+    bool NeedsRender() const;
+
+    /**
+     * @brief 设置窗口的目标帧率
+     * @param fps 每秒帧数，小于等于0表示不限制帧率
+     *
+     * 帧调度器按照该帧率为窗口安排渲染时间点，落后时丢弃过时的帧
+     */
+    void SetTargetFrameRate(double fps);
+
+    /**
+     * @brief 使用窗口所在显示器的刷新率作为目标帧率
+     *
+     * 通过glfwGetVideoMode查询刷新率，查询失败时使用60 FPS
+     */
+    void SetFrameRateMatchMonitor();
+
+    /**
+     * @brief 获取窗口的目标帧率
+     * @return 目标帧率，0表示不限制
+     */
+    double GetTargetFrameRate() const;
+
+    /**
+     * @brief 获取窗口的帧统计信息
+     */
+    FrameStats GetFrameStats() const;
+
+    /**
+     * @brief 启用或关闭独立渲染线程
+     * @param enabled true表示启用
+     *
+     * 启用后主线程只负责布局并把控件树的绘制命令记录为不可变的帧快照，
+     * 由窗口自己的渲染线程光栅化到后缓冲并呈现，输入处理不再等待光栅化。
+     * 渲染线程来不及处理的旧快照会被新快照替换。
+     * 启用时渲染器改为使用自己打开的X连接，不与主线程的GLFW连接共享。
+     */
+    void SetThreadedRendering(bool enabled);
+
+    /**
+     * @brief 检查是否启用了独立渲染线程
+     */
+    bool IsThreadedRendering() const;
+
+    /**
+     * @brief 设置光栅化线程数
+     * @param threads 1表示在渲染线程中串行光栅化（默认），0表示使用线程池的全部工作线程
+     *
+     * 大于1时后缓冲按图块划分，每帧的显示列表在多个线程上并行回放到损坏的图块中
+     */
+    void SetRasterThreads(int threads);
+
+    /**
+     * @brief 获取光栅化线程数
+     */
+    int GetRasterThreads() const;
+
+    /**
+     * @brief 启用或关闭低延迟输入模式
+     * @param enabled true表示启用
+     * @param maxArea 触发立即重绘的最大区域面积（像素）
+     *
+     * 启用后，按键、字符、鼠标按钮和滚轮事件如果只影响一个面积不超过maxArea的控件，
+     * 会在事件回调中立即局部重绘该控件并呈现，不等待下一次主循环迭代。
+     * 启用渲染线程时不生效
+     */
+    void SetLowLatencyMode(bool enabled, double maxArea = 256.0 * 64.0);
+
+    /**
+     * @brief 获取输入到呈现的延迟直方图
+     *
+     * 从窗口收到第一个尚未呈现的输入事件开始，到包含该事件结果的帧呈现（或提交给渲染线程）为止；
+     * 没有造成任何重绘的输入不计入
+     */
+    const LatencyHistogram& GetInputLatencyHistogram() const;
+
+    /**
+     * @brief 清空输入延迟直方图
+     */
+    void ResetInputLatencyHistogram();
+
     /**
      * @brief 检查窗口是否应该关闭
      * @return 窗口应该关闭返回true，否则返回false
      */
     bool ShouldClose() const;
 
+    /**
+     * @brief 请求关闭窗口
+     */
+    void Close();
+
+    /**
+     * @brief 是否为无窗口（headless）窗口
+     */
+    bool IsHeadless() const;
+
+    /**
+     * @brief 获取最近一帧的图像表面（渲染器的后缓冲）
+     * @return 图像表面，渲染器不存在时返回nullptr
+     */
+    cairo_surface_t* GetFrameSurface() const;
+
+    /**
+     * @brief 将最近一帧保存为图片
+     * @param path 文件路径，扩展名为.ppm时保存为PPM，否则保存为PNG
+     * @return 成功返回true
+     */
+    bool SaveFrame(const std::string& path);
+
+    /**
+     * @brief 捕获当前控件树的帧显示列表
+     *
+     * 列表只读，可以保存下来离线回放（例如回放到recording surface或图像表面）
+     * @return 没有根容器时返回nullptr
+     */
+    SDisplayListPtr CaptureDisplayList();
+
+    /**
+     * @brief 注入鼠标移动事件（窗口坐标）
+     *
+     * 注入的事件与窗口系统的事件走相同的处理路径，主要用于无窗口模式
+     */
+    void InjectMouseMove(double x, double y);
+
+    /**
+     * @brief 在当前鼠标位置注入鼠标按钮事件
+     */
+    void InjectMouseButton(MouseButton button, bool pressed, int mods = 0);
+
+    /**
+     * @brief 在当前鼠标位置注入滚轮事件
+     */
+    void InjectScroll(double xoffset, double yoffset);
+
+    /**
+     * @brief 注入键盘事件
+     * @param key 按键代码（GLFW_KEY_*）
+     */
+    void InjectKey(int key, KeyEventType type, int mods = 0);
+
+    /**
+     * @brief 注入字符输入事件
+     */
+    void InjectChar(unsigned int codepoint);
+
+    /**
+     * @brief 调整窗口大小
+     */
+    void InjectResize(int width, int height);
+
     /**
      * @brief 获取GLFW窗口指针
      * @return GLFWwindow指针
@@ -95,7 +383,93 @@ private:
     SWindowManager* manager_;
     GLFWwindow* window_; // GLFWwindow指针
     std::unique_ptr<sgui::SCairoRenderer> cairoRenderer_; // 简化的Cairo渲染器
+    std::unique_ptr<sgui::SRenderThread> renderThread_;   // 渲染线程（启用时），需要先于渲染器销毁
+    std::vector<MouseEvent> pendingMotion_; // 尚未分发的鼠标移动事件（窗口坐标）
+    bool headless_ = false;       // 无窗口模式
+    bool closeRequested_ = false; // 无窗口模式下的关闭请求
+    double cursorX_ = 0.0;        // 当前鼠标位置（窗口坐标）
+    double cursorY_ = 0.0;
+
+    // 低延迟输入
+    bool lowLatency_ = false;
+    double lowLatencyMaxArea_ = 0.0;
+    bool hasPendingInput_ = false;                              // 是否有尚未呈现的输入
+    std::chrono::steady_clock::time_point pendingInputTime_{}; // 第一个尚未呈现的输入的时间
+    LatencyHistogram inputLatency_;
+
+    /**
+     * @brief 记录输入事件到达的时间
+     */
+    void noteInput();
+
+    /**
+     * @brief 记录输入到呈现的延迟
+     */
+    void notePresented();
+
+    /**
+     * @brief 低延迟模式下立即局部重绘并呈现输入目标控件
+     * @param target 接收输入的控件
+     */
+    void presentInputImmediately(SContainer* target);
     std::shared_ptr<sgui::SContainer> rootContainer_; // 根容器
+    bool needsRender_ = true; // 窗口是否需要重绘（整个窗口）
+    cairo_region_t* damage_ = nullptr; // 本帧需要重绘的损坏区域（窗口坐标）
+    bool resizePending_ = false;       // 窗口尺寸已变化，渲染器尚未调整
+
+    // 帧调度
+    double targetFps_ = 0.0;                                // 目标帧率，0表示不限制
+    std::chrono::steady_clock::duration frameInterval_{0};  // 帧间隔
+    std::chrono::steady_clock::time_point nextFrameTime_{}; // 下一帧的计划时间点
+    FrameStats frameStats_;
+
+    /**
+     * @brief 检查当前时间是否到达下一帧的计划时间点
+     */
+    bool isFrameDue(std::chrono::steady_clock::time_point now) const;
+
+    /**
+     * @brief 按帧调度规则渲染一帧并更新帧统计
+     * @param now 当前时间
+     * @param continuous 窗口是否持续请求帧（连续模式），用于区分空闲和落后
+     */
+    void renderScheduledFrame(std::chrono::steady_clock::time_point now, bool continuous);
+
+    /**
+     * @brief 分发本帧合并后的鼠标移动事件
+     *
+     * 每帧渲染前调用一次；按钮、滚轮和键盘事件分发前也会先调用，保证事件顺序
+     */
+    void flushMouseMotion();
+
+    /**
+     * @brief 根容器子树需要布局时重新计算布局
+     * @return 进行了布局计算返回true
+     */
+    bool updateLayout();
+
+    /**
+     * @brief 收集本帧的损坏区域到damage_
+     *
+     * 会先更新布局；窗口被整体标记失效时损坏区域为整个窗口
+     * @return 损坏区域非空返回true
+     */
+    bool collectFrameDamage();
+
+    /**
+     * @brief 把控件树中与damage_相交的部分重绘到cr，绘制被裁剪到损坏区域
+     */
+    void renderDamage(cairo_t* cr);
+
+    /**
+     * @brief 计算damage_的面积（像素）
+     */
+    uint64_t damageArea() const;
+
+    /**
+     * @brief 把控件树记录为帧快照并提交给渲染线程
+     */
+    void commitFrameSnapshot();
 
     /**
      * @brief 获取平台特定的窗口ID
@@ -103,12 +477,28 @@ private:
      */
     void* getWindowId();
 
+    /**
+     * @brief 按最新的窗口尺寸调整渲染器，每帧最多一次
+     */
+    void applyPendingResize();
+
+    // 输入和窗口事件处理，平台回调和Inject*都调用这些函数
+    void handleResize(int width, int height);
+    void handleCursorPos(double xpos, double ypos);
+    void handleMouseButton(int button, int action, int mods);
+    void handleScroll(double xoffset, double yoffset);
+    void handleKey(int key, int action, int mods);
+    void handleChar(unsigned int codepoint);
+
     // 窗口大小回调函数
     static void WindowSizeCallback(GLFWwindow* window, int width, int height);
 
     // 窗口关闭回调函数
     static void WindowCloseCallback(GLFWwindow* window);
 
+    // 窗口内容需要刷新（expose）回调函数
+    static void WindowRefreshCallback(GLFWwindow* window);
+
     // 鼠标位置回调函数
     static void MousePosCallback(GLFWwindow* window, double xpos, double ypos);
 
@@ -138,8 +528,9 @@ class SWindowManager {
 public:
     /**
      * @brief 构造函数
+     * @param backend 窗口后端，默认使用GLFW
      */
-    SWindowManager();
+    explicit SWindowManager(WindowBackend backend = WindowBackend::Glfw);
 
     /**
      * @brief 析构函数
@@ -168,19 +559,202 @@ public:
     /**
      * @brief 运行主循环
      *
-     * 执行窗口的主渲染循环，直到所有窗口被关闭
+     * 执行窗口的主渲染循环，直到所有窗口被关闭。
+     * 无窗口模式下没有待处理的工作时返回：先等待共享线程池中已提交的任务（例如图片解码）执行完并处理它们的完成回调，
+     * 一次性定时器会推进虚拟时钟直到执行；只剩下重复定时器（例如光标闪烁）时不再推进，直接返回
      */
     void Run();
 
+    /**
+     * @brief 请求在帧与帧之间的空闲时间执行回调
+     * @param callback 回调，参数给出本次空闲时段的截止时间
+     * @param timeoutMs 超时时间（毫秒），0表示不超时；超时后即使没有空闲时间也会执行
+     * @return 回调ID
+     *
+     * 空闲时段从窗口渲染完成开始，到最近一个窗口的下一帧时间点或定时器到期为止，
+     * 没有帧需要渲染时最长为50ms。未限制帧率的窗口持续渲染时，空闲时段为60Hz名义帧预算的剩余部分，
+     * 至少1ms。回调中再次请求的回调在下一个空闲时段执行
+     */
+    uint64_t RequestIdleCallback(IdleCallback callback, uint32_t timeoutMs = 0);
+
+    /**
+     * @brief 取消空闲回调
+     */
+    void CancelIdleCallback(uint64_t id);
+
+    /**
+     * @brief 执行一次主循环迭代（不等待事件）
+     *
+     * 执行投递的任务和到期的定时器，渲染到达帧时间的窗口并移除关闭的窗口。
+     * 无窗口模式下可以与AdvanceTime配合逐帧驱动
+     */
+    void RunFrame();
+
+    /**
+     * @brief 是否为无窗口模式
+     */
+    bool IsHeadless() const;
+
+    /**
+     * @brief 获取主循环使用的当前时间
+     *
+     * 无窗口模式下为虚拟时钟，只通过AdvanceTime推进
+     */
+    std::chrono::steady_clock::time_point Now() const;
+
+    /**
+     * @brief 推进虚拟时钟（仅无窗口模式有效）
+     */
+    void AdvanceTime(std::chrono::steady_clock::duration delta);
+
     /**
      * @brief 获取当前窗口数量
      * @return 当前管理的窗口数量
      */
     size_t GetWindowCount() const;
 
+    /**
+     * @brief 设置主循环运行模式
+     * @param mode 运行模式，默认为LoopMode::Continuous
+     *
+     * 事件驱动模式下主循环阻塞在glfwWaitEvents中，空闲时不占用CPU。
+     * 无窗口模式总是按事件驱动模式运行，Run()在没有待处理的工作时返回
+     */
+    void SetLoopMode(LoopMode mode);
+
+    /**
+     * @brief 获取主循环运行模式
+     */
+    LoopMode GetLoopMode() const;
+
+    /**
+     * @brief 唤醒阻塞中的主循环
+     *
+     * 通过glfwPostEmptyEvent实现，可以在任意线程调用
+     */
+    void Wakeup();
+
+    /**
+     * @brief 获取主循环统计信息
+     */
+    LoopStats GetLoopStats() const;
+
+    /**
+     * @brief 投递任务到UI线程执行
+     * @param task 任务
+     *
+     * 可以在任意线程调用。主循环每次迭代执行一次所有已投递的任务，
+     * 因此同一帧内的大量投递只会触发一次唤醒、一次布局和一次重绘
+     */
+    void Post(std::function<void()> task);
+
+    /**
+     * @brief 在UI线程执行函数并通过future获取结果
+     * @param fn 函数
+     * @return 函数返回值的future，函数抛出的异常会通过future传递
+     *
+     * 不要在UI线程中等待返回的future，否则会死锁
+     */
+    template <typename F>
+    auto Invoke(F&& fn) -> std::future<decltype(fn())>
+    {
+        using Result = decltype(fn());
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(fn));
+        auto future = task->get_future();
+        Post([task]() { (*task)(); });
+        return future;
+    }
+
+    /**
+     * @brief 获取窗口管理器持有的定时器服务
+     *
+     * 定时器和动画帧回调在主循环中执行，主循环根据最近的到期时间决定等待超时
+     */
+    STimerService& GetTimerService();
+
 private:
     std::vector<std::shared_ptr<SWindow>> windows_;
-    bool glfw_initialized_;
+    std::atomic<bool> glfw_initialized_;
+    WindowBackend backend_;
+    std::chrono::steady_clock::time_point virtualNow_; // 无窗口模式的虚拟时钟，需要在定时器服务之前初始化
+    std::unique_ptr<STaskQueue> taskQueue_; // 跨线程投递的UI任务
+    std::unique_ptr<STimerService> timers_; // 定时器服务
+
+    // 空闲回调，按请求顺序（ID递增）执行
+    struct IdleRequest
+    {
+        IdleCallback callback;
+        bool hasTimeout = false;
+        std::chrono::steady_clock::time_point timeoutAt;
+    };
+    std::map<uint64_t, IdleRequest> idleCallbacks_;
+    uint64_t nextIdleId_ = 1;
+    LoopMode loopMode_ = LoopMode::Continuous;
+
+    // 主循环统计
+    LoopStats stats_;
+    uint64_t wakeupsInPeriod_ = 0;
+    std::chrono::steady_clock::time_point statsPeriodStart_;
+
+    /**
+     * @brief 计算下一次等待事件的超时时间
+     * @return 超时时间（秒），小于0表示无限等待，0表示只轮询
+     *
+     * 根据各窗口的失效状态和下一帧计划时间点计算
+     */
+    double computeWaitTimeout() const;
+
+    /**
+     * @brief 主循环是否实际按连续模式运行（无窗口模式总是按事件驱动模式运行）
+     */
+    bool isContinuous() const;
+
+    /**
+     * @brief 无窗口模式下除了重复定时器和后台任务以外是否已经没有待处理的工作
+     * @param timeout computeWaitTimeout()的结果
+     */
+    bool isHeadlessIdle(double timeout) const;
+
+    /**
+     * @brief 把自己设置为当前定时器服务和线程池完成回调的投递目标
+     *
+     * 创建时调用；当前管理器销毁时由仍然存在的最后一个管理器重新设置
+     */
+    void installGlobals();
+
+    /**
+     * @brief 处理窗口事件
+     * @param timeout 等待超时时间（秒），小于0表示无限等待，0表示只轮询
+     */
+    void waitForEvents(double timeout);
+
+    /**
+     * @brief 记录一次主循环唤醒并更新每秒唤醒次数
+     */
+    void recordWakeup();
+
+    /**
+     * @brief 执行所有已投递的UI任务
+     */
+    void drainTasks();
+
+    /**
+     * @brief 执行到期的定时器，有窗口到达帧时间时执行动画帧回调
+     */
+    void runTimers();
+
+    /**
+     * @brief 计算当前空闲时段的截止时间
+     *
+     * 取最近一个将要渲染的窗口的下一帧时间点和最近的定时器到期时间，最长50ms；
+     * 未限制帧率的窗口取名义帧预算的剩余部分，至少1ms
+     */
+    std::chrono::steady_clock::time_point computeIdleDeadline(std::chrono::steady_clock::time_point now) const;
+
+    /**
+     * @brief 在空闲时段内执行空闲回调
+     */
+    void runIdleCallbacks();
 
     // 禁止复制和赋值
     SWindowManager(const SWindowManager&) = delete;
@@ -24,8 +24,8 @@ SButton::SButton()
     setTextAlign(TextAlign::Center);
 
     // 标记样式已更改，通过公共接口
-    // 由于 markStylesDirty 是私有的，我们使用 markDirty() 来标记需要重新绘制
-    markDirty();
+    // 由于 markStylesDirty 是私有的，我们使用 markPaintDirty() 来标记需要重新绘制
+    markPaintDirty();
 }
 
 SButton::SButton(const std::string &text) : SButton()
@@ -162,7 +162,7 @@ void SButton::updateAppearance()
     }
 
     // 标记样式已更改，通过公共接口
-    markDirty();
+    markPaintDirty();
 }
 
 void SButton::onMousePressed(const MouseEvent &event)
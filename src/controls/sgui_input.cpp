@@ -30,7 +30,7 @@ SInput::SInput()
     // 初始化光标闪烁时间
     m_lastBlinkTime = std::chrono::steady_clock::now();
     
-    markDirty();
+    markPaintDirty();
 }
 
 SInput::SInput(const std::string& placeholder) : SInput()
@@ -38,7 +38,10 @@ SInput::SInput(const std::string& placeholder) : SInput()
     m_placeholder = placeholder;
 }
 
-SInput::~SInput() = default;
+SInput::~SInput()
+{
+    stopCursorBlink();
+}
 
 // ====================================================================
 // 基本属性设置实现
@@ -49,14 +52,14 @@ void SInput::setInputType(InputType type)
     if (m_inputType != type)
     {
         m_inputType = type;
-        markDirty();
+        markPaintDirty();
     }
 }
 
 void SInput::setPlaceholder(const std::string& placeholder)
 {
     m_placeholder = placeholder;
-    markDirty();
+    markPaintDirty();
 }
 
 void SInput::setValue(const std::string& value)
@@ -66,7 +69,7 @@ void SInput::setValue(const std::string& value)
     m_cursorPosition = std::min(m_cursorPosition, static_cast<int>(value.length()));
     clearSelection();
     triggerTextChanged();
-    markDirty();
+    markPaintDirty();
 }
 
 void SInput::setReadOnly(bool readOnly)
@@ -104,7 +107,7 @@ void SInput::setCursorPosition(int position)
     int textLength = static_cast<int>(getText().length());
     m_cursorPosition = std::max(0, std::min(position, textLength));
     clearSelection();
-    markDirty();
+    markPaintDirty();
 }
 
 void SInput::selectAll()
@@ -117,7 +120,7 @@ void SInput::clearSelection()
 {
     m_selectionStart = -1;
     m_selectionEnd = -1;
-    markDirty();
+    markPaintDirty();
 }
 
 bool SInput::hasSelection() const
@@ -303,7 +306,7 @@ void SInput::onMousePressed(const MouseEvent& event)
             clearSelection();
         }
         
-        markDirty();
+        markPaintDirty();
     }
 }
 
@@ -490,6 +493,17 @@ void SInput::setState(ControlState newState)
     }
     
     m_state = newState;
+
+    // 只有获得焦点时才需要光标闪烁
+    if (m_state == ControlState::Focused)
+    {
+        startCursorBlink();
+    }
+    else
+    {
+        stopCursorBlink();
+    }
+
     updateAppearance();
 }
 
@@ -523,7 +537,7 @@ void SInput::updateAppearance()
         break;
     }
     
-    markDirty();
+    markPaintDirty();
 }
 
 std::string SInput::getDisplayText() const
@@ -686,7 +700,7 @@ void SInput::moveCursorTo(int position)
 {
     int textLength = static_cast<int>(getText().length());
     m_cursorPosition = std::max(0, std::min(position, textLength));
-    markDirty();
+    markPaintDirty();
 }
 
 void SInput::selectText(int start, int end)
@@ -694,7 +708,7 @@ void SInput::selectText(int start, int end)
     int textLength = static_cast<int>(getText().length());
     m_selectionStart = std::max(0, std::min(start, textLength));
     m_selectionEnd = std::max(0, std::min(end, textLength));
-    markDirty();
+    markPaintDirty();
 }
 
 void SInput::deleteChar(int position)
@@ -758,6 +772,12 @@ void SInput::updateCursorBlink()
         m_cursorVisible = true;
         return;
     }
+
+    // 由定时器驱动时不需要轮询
+    if (m_blinkTimer != 0)
+    {
+        return;
+    }
     
     auto now = std::chrono::steady_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastBlinkTime);
@@ -766,8 +786,42 @@ void SInput::updateCursorBlink()
     {
         m_cursorVisible = !m_cursorVisible;
         m_lastBlinkTime = now;
-        markDirty();
+        markPaintDirty();
+    }
+}
+
+void SInput::startCursorBlink()
+{
+    stopCursorBlink();
+    m_cursorVisible = true;
+    m_lastBlinkTime = std::chrono::steady_clock::now();
+
+    // 当前服务可能在之后被其他窗口管理器替换，记住创建定时器的服务
+    STimerService *timers = STimerService::current();
+    if (timers)
+    {
+        m_blinkTimerService = timers;
+        m_blinkTimer = timers->setInterval(500, [this]() {
+            m_cursorVisible = !m_cursorVisible;
+            markPaintDirty();
+        });
+    }
+}
+
+void SInput::stopCursorBlink()
+{
+    if (m_blinkTimer == 0)
+    {
+        return;
+    }
+
+    // 服务已经随窗口管理器销毁时，定时器和回调也已经一起销毁
+    if (STimerService::isAlive(m_blinkTimerService))
+    {
+        m_blinkTimerService->clearTimer(m_blinkTimer);
     }
+    m_blinkTimer = 0;
+    m_blinkTimerService = nullptr;
 }
 
 void SInput::addToHistory()
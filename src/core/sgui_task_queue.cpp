@@ -0,0 +1,73 @@
+/**
+ * UI任务队列实现
+ */
+
+#include "internal/sgui_task_queue.h"
+
+namespace sgui {
+
+STaskQueue::STaskQueue()
+    : m_head(&m_stub), m_tail(&m_stub) {
+}
+
+STaskQueue::~STaskQueue() {
+    // 丢弃未执行的任务
+    Node* node = m_tail;
+    while (node) {
+        Node* next = node->next.load(std::memory_order_acquire);
+        if (node != &m_stub) {
+            delete node;
+        }
+        node = next;
+    }
+}
+
+bool STaskQueue::push(Task task) {
+    Node* node = new Node();
+    node->task = std::move(task);
+
+    // 先把节点挂到链表上，再检查唤醒标记，保证消费者清除标记后一定能看到该节点
+    Node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+    m_pushed.fetch_add(1, std::memory_order_release);
+
+    return !m_wakeupPending.exchange(true, std::memory_order_acq_rel);
+}
+
+bool STaskQueue::pop(Task& task) {
+    Node* tail = m_tail;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (!next) {
+        return false;
+    }
+
+    // next成为新的哑节点，取走它的任务
+    task = std::move(next->task);
+    next->task = nullptr;
+    m_tail = next;
+    if (tail != &m_stub) {
+        delete tail;
+    }
+    return true;
+}
+
+size_t STaskQueue::drain() {
+    // 清除唤醒标记后再读取队列，之后的投递会重新触发唤醒
+    m_wakeupPending.store(false, std::memory_order_seq_cst);
+
+    uint64_t target = m_pushed.load(std::memory_order_acquire);
+    size_t executed = 0;
+    Task task;
+    while (m_popped < target && pop(task)) {
+        m_popped++;
+        task();
+        executed++;
+    }
+    return executed;
+}
+
+bool STaskQueue::empty() const {
+    return m_tail->next.load(std::memory_order_acquire) == nullptr;
+}
+
+} // namespace sgui
@@ -0,0 +1,229 @@
+/**
+ * 后台线程池实现
+ */
+
+#include "sgui_thread_pool.h"
+#include <algorithm>
+#include <iostream>
+
+namespace sgui {
+
+namespace {
+
+// 当前线程所属的线程池和队列索引
+thread_local const SThreadPool* t_currentPool = nullptr;
+thread_local size_t t_workerIndex = 0;
+
+std::mutex g_instanceMutex;
+std::unique_ptr<SThreadPool> g_instance;
+
+std::mutex g_dispatcherMutex;
+SThreadPool::CompletionDispatcher g_dispatcher;
+
+size_t defaultThreadCount() {
+    size_t count = std::thread::hardware_concurrency();
+    return count > 0 ? count : 2;
+}
+
+} // namespace
+
+SThreadPool::SThreadPool(size_t threadCount) {
+    start(threadCount);
+}
+
+SThreadPool::~SThreadPool() {
+    stop();
+}
+
+SThreadPool& SThreadPool::instance() {
+    std::lock_guard<std::mutex> lock(g_instanceMutex);
+    if (!g_instance) {
+        g_instance = std::make_unique<SThreadPool>();
+    }
+    return *g_instance;
+}
+
+SThreadPool* SThreadPool::existingInstance() {
+    std::lock_guard<std::mutex> lock(g_instanceMutex);
+    return g_instance.get();
+}
+
+void SThreadPool::configure(size_t threadCount) {
+    std::lock_guard<std::mutex> lock(g_instanceMutex);
+    if (!g_instance) {
+        g_instance = std::make_unique<SThreadPool>(threadCount);
+        return;
+    }
+    g_instance->stop();
+    g_instance->start(threadCount);
+}
+
+void SThreadPool::setCompletionDispatcher(CompletionDispatcher dispatcher) {
+    std::lock_guard<std::mutex> lock(g_dispatcherMutex);
+    g_dispatcher = std::move(dispatcher);
+}
+
+bool SThreadPool::hasCompletionDispatcher() {
+    std::lock_guard<std::mutex> lock(g_dispatcherMutex);
+    return static_cast<bool>(g_dispatcher);
+}
+
+bool SThreadPool::postCompletion(Task completion) {
+    std::lock_guard<std::mutex> lock(g_dispatcherMutex);
+    if (!g_dispatcher) {
+        return false;
+    }
+    g_dispatcher(std::move(completion));
+    return true;
+}
+
+void SThreadPool::dispatchCompletion(Task completion) {
+    {
+        std::lock_guard<std::mutex> lock(g_dispatcherMutex);
+        if (g_dispatcher) {
+            g_dispatcher(std::move(completion));
+            return;
+        }
+    }
+    completion();
+}
+
+void SThreadPool::dispatchError(std::exception_ptr error, ErrorHandler onError) {
+    if (onError) {
+        dispatchCompletion([onError = std::move(onError), error]() { onError(error); });
+        return;
+    }
+
+    try {
+        std::rethrow_exception(error);
+    } catch (const std::exception& e) {
+        std::cerr << "Unhandled exception in thread pool task: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unhandled exception in thread pool task" << std::endl;
+    }
+}
+
+bool SThreadPool::isWorkerThread() const {
+    return t_currentPool == this;
+}
+
+void SThreadPool::start(size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = defaultThreadCount();
+    }
+
+    // 此时没有工作线程；阻塞其他线程的提交，直到新队列和工作线程就绪
+    std::unique_lock<std::shared_mutex> lock(m_queuesMutex);
+
+    // 旧工作线程退出后提交的任务仍在旧队列中（已经计入m_pending），转移到新队列
+    std::vector<Task> leftover;
+    for (auto& queue : m_queues) {
+        for (auto& task : queue->tasks) {
+            leftover.push_back(std::move(task));
+        }
+    }
+
+    m_queues.clear();
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (size_t i = 0; i < leftover.size(); ++i) {
+        m_queues[i % threadCount]->tasks.push_back(std::move(leftover[i]));
+    }
+
+    {
+        std::lock_guard<std::mutex> sleepLock(m_sleepMutex);
+        m_stopping = false;
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back(&SThreadPool::workerMain, this, i);
+    }
+}
+
+void SThreadPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_sleepCv.notify_all();
+
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    m_workers.clear();
+}
+
+void SThreadPool::enqueue(Task task) {
+    // 重新配置期间等待新队列就绪
+    std::shared_lock<std::shared_mutex> queuesLock(m_queuesMutex);
+    m_outstanding.fetch_add(1, std::memory_order_acq_rel);
+
+    // 工作线程提交的任务放入自己的队列，保持局部性；外部线程轮流分配
+    size_t index = isWorkerThread() ? t_workerIndex : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+        m_queues[index]->tasks.push_back(std::move(task));
+    }
+
+    // 入队后再增加计数，被唤醒的线程一定能取到任务，不会空转等待入队
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_pending.fetch_add(1, std::memory_order_release);
+    }
+    m_sleepCv.notify_one();
+}
+
+bool SThreadPool::popTask(size_t index, Task& task) {
+    // 先从自己队列的尾部取（后进先出）
+    {
+        WorkerQueue& own = *m_queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // 再从其他队列的头部窃取（先进先出）
+    for (size_t offset = 1; offset < m_queues.size(); ++offset) {
+        WorkerQueue& victim = *m_queues[(index + offset) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void SThreadPool::workerMain(size_t index) {
+    t_currentPool = this;
+    t_workerIndex = index;
+
+    while (true) {
+        Task task;
+        if (popTask(index, task)) {
+            m_pending.fetch_sub(1, std::memory_order_acq_rel);
+            task();
+            if (m_outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                // 持有锁再通知，避免waitIdleFor检查条件后、开始等待前错过通知
+                std::lock_guard<std::mutex> lock(m_idleMutex);
+                m_idleCv.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleepCv.wait(lock, [this] { return m_stopping || m_pending.load(std::memory_order_acquire) > 0; });
+        // 退出前执行完所有已提交的任务
+        if (m_stopping && m_pending.load(std::memory_order_acquire) <= 0) {
+            return;
+        }
+    }
+}
+
+} // namespace sgui
@@ -0,0 +1,285 @@
+/**
+ * 定时器服务实现
+ */
+
+#include "sgui_timer.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace sgui {
+
+namespace {
+
+STimerService* g_currentTimerService = nullptr;
+
+// 存在的定时器服务（只在UI线程访问）
+std::vector<const STimerService*> g_liveTimerServices;
+
+// 定时器ID在所有服务之间递增，服务销毁后在同一地址创建的新服务不会复用旧ID
+std::atomic<TimerId> g_nextTimerId{1};
+
+// 最低位的置位位置，bits不能为0
+inline int lowestBit(uint64_t bits) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+} // namespace
+
+STimerService::STimerService(ClockFunction clock)
+    : m_clock(std::move(clock)) {
+    if (!m_clock) {
+        m_clock = [] { return Clock::now(); };
+    }
+    m_start = m_clock();
+    g_liveTimerServices.push_back(this);
+}
+
+STimerService::~STimerService() {
+    if (g_currentTimerService == this) {
+        g_currentTimerService = nullptr;
+    }
+    g_liveTimerServices.erase(std::remove(g_liveTimerServices.begin(), g_liveTimerServices.end(), this),
+                              g_liveTimerServices.end());
+}
+
+STimerService* STimerService::current() {
+    return g_currentTimerService;
+}
+
+void STimerService::setCurrent(STimerService* service) {
+    g_currentTimerService = service;
+}
+
+bool STimerService::isAlive(const STimerService* service) {
+    return service && std::find(g_liveTimerServices.begin(), g_liveTimerServices.end(), service) != g_liveTimerServices.end();
+}
+
+STimerService::Clock::time_point STimerService::now() const {
+    return m_clock();
+}
+
+TimerId STimerService::setTimeout(uint32_t delayMs, TimerCallback callback) {
+    TimerId id = g_nextTimerId++;
+    Timer timer;
+    // 时间轮可能在主线程阻塞期间没有推进，以真实时间计算到期点，且至少在下一个tick到期
+    timer.expireTick = std::max(m_currentTick + 1, toTick(now()) + delayMs);
+    timer.callback = std::move(callback);
+    uint64_t expireTick = timer.expireTick;
+    m_timers.emplace(id, std::move(timer));
+    insert(id, expireTick);
+    return id;
+}
+
+TimerId STimerService::setInterval(uint32_t intervalMs, TimerCallback callback) {
+    intervalMs = std::max<uint32_t>(intervalMs, 1);
+    TimerId id = setTimeout(intervalMs, std::move(callback));
+    m_timers[id].intervalMs = intervalMs;
+    return id;
+}
+
+void STimerService::clearTimer(TimerId id) {
+    // 槽中残留的ID在处理该槽时跳过
+    m_timers.erase(id);
+}
+
+TimerId STimerService::requestAnimationFrame(AnimationFrameCallback callback) {
+    TimerId id = g_nextTimerId++;
+    m_frameCallbacks.emplace_back(id, std::move(callback));
+    return id;
+}
+
+void STimerService::cancelAnimationFrame(TimerId id) {
+    m_frameCallbacks.erase(
+        std::remove_if(m_frameCallbacks.begin(), m_frameCallbacks.end(),
+                       [id](const std::pair<TimerId, AnimationFrameCallback>& entry) { return entry.first == id; }),
+        m_frameCallbacks.end());
+}
+
+size_t STimerService::advance() {
+    uint64_t target = toTick(now());
+    size_t fired = 0;
+
+    while (m_currentTick < target) {
+        // 跳过第0层中的空槽：直接前进到本轮下一个非空槽，或者下一轮的起点（需要降级高层定时器）
+        uint64_t index = m_currentTick & kSlotMask;
+        uint64_t pending = index == kSlotMask ? 0 : (m_levels[0].occupied & (~0ULL << (index + 1)));
+        uint64_t next = pending ? ((m_currentTick & ~kSlotMask) + lowestBit(pending)) : ((m_currentTick | kSlotMask) + 1);
+        if (next > target) {
+            m_currentTick = target;
+            break;
+        }
+        m_currentTick = next;
+
+        if ((next & kSlotMask) == 0) {
+            for (int level = 1; level < kLevels; ++level) {
+                uint64_t slot = (next >> (kSlotBits * level)) & kSlotMask;
+                cascade(level, slot);
+                if (slot != 0) {
+                    break;
+                }
+            }
+        }
+
+        fired += expire(next);
+    }
+    return fired;
+}
+
+size_t STimerService::runAnimationFrames(Clock::time_point frameTime) {
+    std::vector<std::pair<TimerId, AnimationFrameCallback>> callbacks;
+    callbacks.swap(m_frameCallbacks);
+    for (auto& entry : callbacks) {
+        entry.second(frameTime);
+    }
+    return callbacks.size();
+}
+
+bool STimerService::hasOneShotTimers() const {
+    for (const auto& entry : m_timers) {
+        if (entry.second.intervalMs == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool STimerService::nextDeadline(Clock::time_point& deadline) const {
+    if (m_timers.empty()) {
+        return false;
+    }
+
+    uint64_t best = std::numeric_limits<uint64_t>::max();
+
+    // 第0层：本轮剩余的槽，其次是下一轮的槽
+    uint64_t index = m_currentTick & kSlotMask;
+    uint64_t base = m_currentTick & ~kSlotMask;
+    uint64_t occupied = m_levels[0].occupied;
+    uint64_t pending = index == kSlotMask ? 0 : (occupied & (~0ULL << (index + 1)));
+    if (pending) {
+        best = base + lowestBit(pending);
+    } else if (occupied) {
+        best = base + kSlots + lowestBit(occupied);
+    }
+
+    // 高层：最近一个非空槽降级的时间
+    for (int level = 1; level < kLevels; ++level) {
+        uint64_t levelOccupied = m_levels[level].occupied;
+        if (!levelOccupied) {
+            continue;
+        }
+        int shift = kSlotBits * level;
+        uint64_t block = m_currentTick >> shift;
+        for (uint64_t k = 1; k <= kSlots; ++k) {
+            if (levelOccupied & (1ULL << ((block + k) & kSlotMask))) {
+                best = std::min(best, (block + k) << shift);
+                break;
+            }
+        }
+    }
+
+    if (best == std::numeric_limits<uint64_t>::max()) {
+        return false;
+    }
+    deadline = fromTick(best);
+    return true;
+}
+
+uint64_t STimerService::toTick(Clock::time_point time) const {
+    if (time <= m_start) {
+        return 0;
+    }
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(time - m_start).count());
+}
+
+STimerService::Clock::time_point STimerService::fromTick(uint64_t tick) const {
+    return m_start + std::chrono::milliseconds(tick);
+}
+
+void STimerService::insert(TimerId id, uint64_t expireTick) {
+    uint64_t delta = expireTick > m_currentTick ? expireTick - m_currentTick : 0;
+
+    int level = 0;
+    while (level < kLevels - 1 && delta >= (1ULL << (kSlotBits * (level + 1)))) {
+        level++;
+    }
+
+    // 超出时间轮范围的定时器先放在最高层最远的槽，降级时按真实到期时间重新插入
+    uint64_t maxDelta = (1ULL << (kSlotBits * kLevels)) - 1;
+    // 已经到期的定时器放在当前槽，由正在进行的expire处理
+    uint64_t slotTick = delta > maxDelta ? m_currentTick + maxDelta : std::max(expireTick, m_currentTick);
+
+    uint64_t slot = (slotTick >> (kSlotBits * level)) & kSlotMask;
+    m_levels[level].slots[slot].push_back(id);
+    m_levels[level].occupied |= 1ULL << slot;
+}
+
+void STimerService::cascade(int level, uint64_t slot) {
+    std::vector<TimerId> ids;
+    ids.swap(m_levels[level].slots[slot]);
+    m_levels[level].occupied &= ~(1ULL << slot);
+
+    for (TimerId id : ids) {
+        auto it = m_timers.find(id);
+        if (it != m_timers.end()) {
+            insert(id, it->second.expireTick);
+        }
+    }
+}
+
+size_t STimerService::expire(uint64_t tick) {
+    uint64_t slot = tick & kSlotMask;
+    std::vector<TimerId> ids;
+    ids.swap(m_levels[0].slots[slot]);
+    m_levels[0].occupied &= ~(1ULL << slot);
+
+    std::vector<TimerId> due;
+    for (TimerId id : ids) {
+        auto it = m_timers.find(id);
+        if (it == m_timers.end()) {
+            continue;
+        }
+        if (it->second.expireTick > tick) {
+            insert(id, it->second.expireTick);
+        } else {
+            due.push_back(id);
+        }
+    }
+
+    // 回调可能增删定时器，执行前重新查找
+    size_t fired = 0;
+    for (TimerId id : due) {
+        auto it = m_timers.find(id);
+        if (it == m_timers.end()) {
+            continue;
+        }
+
+        TimerCallback callback;
+        if (it->second.intervalMs > 0) {
+            callback = it->second.callback;
+            it->second.expireTick = tick + it->second.intervalMs;
+            insert(id, it->second.expireTick);
+        } else {
+            callback = std::move(it->second.callback);
+            m_timers.erase(it);
+        }
+
+        if (callback) {
+            callback();
+        }
+        fired++;
+    }
+    return fired;
+}
+
+} // namespace sgui
@@ -0,0 +1,117 @@
+/**
+ * 后缓冲存储池
+ *
+ * 交互式调整窗口大小时，渲染器在短时间内需要大量不同尺寸的后缓冲。
+ * 存储池缓存释放的后缓冲存储，之后尺寸能容纳的请求直接复用，
+ * 大块存储使用mmap分配并提示内核使用透明大页，减少缺页和TLB开销。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace sgui {
+
+/**
+ * 后缓冲存储
+ *
+ * 按CAIRO_FORMAT_ARGB32的行距排列，可以容纳width x height的图像
+ */
+struct SBackBuffer {
+    unsigned char* data = nullptr;
+    size_t size = 0;  // 分配的字节数
+    int width = 0;    // 可容纳的最大宽度
+    int height = 0;   // 可容纳的最大高度
+    int stride = 0;   // 行距（字节）
+    bool mapped = false; // 使用mmap分配
+
+    explicit operator bool() const { return data != nullptr; }
+};
+
+/**
+ * 存储池统计信息
+ */
+struct BackBufferPoolStats {
+    uint64_t allocations = 0;   // 新分配次数
+    uint64_t reuses = 0;        // 复用缓存次数
+    uint64_t hugePageBuffers = 0; // 使用大页提示分配的次数
+    size_t cachedBytes = 0;     // 当前缓存的字节数
+};
+
+/**
+ * 后缓冲存储池类（线程安全，所有窗口共享）
+ */
+class SBackBufferPool {
+public:
+    /**
+     * 过度分配的增长系数：存储需要变大时至少增长到原来的kGrowthFactor倍
+     */
+    static constexpr double kGrowthFactor = 1.5;
+
+    /**
+     * 大于该字节数的存储使用mmap分配并提示使用大页
+     */
+    static constexpr size_t kHugePageThreshold = 2 * 1024 * 1024;
+
+    /**
+     * 获取全局存储池
+     * 存储池在进程退出时不析构，静态对象持有的渲染器析构时仍然可以归还存储
+     */
+    static SBackBufferPool& instance();
+
+    SBackBufferPool() = default;
+    ~SBackBufferPool();
+
+    SBackBufferPool(const SBackBufferPool&) = delete;
+    SBackBufferPool& operator=(const SBackBufferPool&) = delete;
+
+    /**
+     * 获取至少能容纳width x height的存储
+     * 优先复用缓存中能容纳的最小存储，否则按请求尺寸新分配
+     * @param reused 输出是否复用了缓存（可为nullptr）
+     * @return 分配失败时返回空存储
+     */
+    SBackBuffer acquire(int width, int height, bool* reused = nullptr);
+
+    /**
+     * 归还存储，缓存超过预算时释放最早归还的存储
+     */
+    void release(SBackBuffer buffer);
+
+    /**
+     * 释放所有缓存的存储
+     */
+    void trim();
+
+    /**
+     * 设置缓存预算（字节）
+     */
+    void setCacheBudget(size_t bytes);
+
+    /**
+     * 获取统计信息
+     */
+    BackBufferPoolStats getStats() const;
+
+    /**
+     * 计算从当前容量增长到能容纳请求尺寸时应分配的尺寸
+     * 超出的维度至少增长kGrowthFactor倍，没有超出的维度保持当前容量
+     */
+    static void growSize(int currentWidth, int currentHeight, int requestWidth, int requestHeight,
+                         int& width, int& height);
+
+private:
+    static SBackBuffer allocate(int width, int height);
+    static void freeBuffer(SBackBuffer& buffer);
+    void evictLocked();
+
+    mutable std::mutex m_mutex;
+    std::vector<SBackBuffer> m_cached; // 按归还顺序排列，最早归还的在前
+    size_t m_cacheBudget = 128 * 1024 * 1024;
+    BackBufferPoolStats m_stats;
+};
+
+} // namespace sgui
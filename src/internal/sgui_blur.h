@@ -0,0 +1,54 @@
+/**
+ * A8图像模糊
+ *
+ * 高斯模糊用三次盒式模糊近似，每次盒式模糊分为水平和垂直两遍，
+ * 每遍用滑动窗口求和，耗时与模糊半径无关。
+ * 逐列的滑动求和按SSE2/AVX2向量化，运行时根据CPU选择实现，不支持时使用标量实现；
+ * 所有实现使用相同的浮点运算，输出逐字节一致。
+ */
+
+#pragma once
+
+namespace sgui {
+
+/**
+ * 模糊实现
+ */
+enum class BlurKernel {
+    Scalar, // 标量实现
+    SSE2,   // 每次处理16列
+    AVX2    // 每次处理32列
+};
+
+/**
+ * 当前CPU支持的最快实现
+ */
+BlurKernel detectBlurKernel();
+
+/**
+ * 实现的名称，用于日志和性能测试
+ */
+const char* blurKernelName(BlurKernel kernel);
+
+/**
+ * 高斯模糊后像素向外扩展的最大距离（三次盒式模糊的半径之和）
+ * @param sigma 高斯标准差，CSS的模糊半径为2倍标准差
+ */
+int gaussianBlurExtent(double sigma);
+
+/**
+ * 对CAIRO_FORMAT_A8图像做高斯模糊（原地），图像以外的像素视为边缘像素的延伸
+ * @param data 像素数据
+ * @param width/height 图像尺寸
+ * @param stride 行距（字节）
+ * @param sigma 高斯标准差
+ * @param kernel 使用的实现
+ */
+void gaussianBlurA8(unsigned char* data, int width, int height, int stride, double sigma, BlurKernel kernel);
+
+/**
+ * 使用detectBlurKernel()选择的实现做高斯模糊
+ */
+void gaussianBlurA8(unsigned char* data, int width, int height, int stride, double sigma);
+
+} // namespace sgui
@@ -0,0 +1,31 @@
+/**
+ * 呈现矩形合并
+ *
+ * 损坏区域由许多小矩形组成，每个呈现矩形都有固定开销（X请求、裁剪设置等）。
+ * 呈现前按代价模型把矩形合并为少量较大的矩形。
+ */
+
+#pragma once
+
+#include <cairo/cairo.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sgui {
+
+/**
+ * 每个呈现矩形的固定开销，折算为像素数
+ */
+constexpr int64_t kPresentRectOverhead = 64 * 64;
+
+/**
+ * 贪心合并矩形
+ * 每次合并浪费面积最小的一对：浪费不超过单个矩形的固定开销时合并总是划算的，
+ * 矩形数超过上限时即使不划算也要继续合并
+ * @param rects 输入矩形，合并结果写回；结果覆盖所有输入矩形
+ * @param maxRects 结果的最大矩形数
+ */
+void mergePresentRects(std::vector<cairo_rectangle_int_t>& rects, size_t maxRects);
+
+} // namespace sgui
@@ -0,0 +1,101 @@
+/**
+ * 窗口渲染线程
+ *
+ * 主线程提交不可变的帧快照（整棵控件树的帧显示列表），
+ * 渲染线程负责把快照光栅化到SCairoRenderer的后缓冲并呈现到窗口，
+ * 这样输入处理不会被光栅化阻塞。
+ */
+
+#pragma once
+
+#include <cairo/cairo.h>
+#include "sgui_display_list.h"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace sgui {
+
+class SCairoRenderer;
+
+/**
+ * 帧快照
+ *
+ * 提交后由渲染线程独占，主线程不再访问
+ */
+struct FrameSnapshot {
+    SDisplayListPtr displayList; // 记录了整棵控件树绘制命令的帧显示列表
+    int width = 0;
+    int height = 0;
+};
+
+/**
+ * 渲染线程类
+ *
+ * 采用"信箱"模式：只保留最新提交的快照，渲染线程来不及处理的旧快照直接丢弃
+ */
+class SRenderThread {
+public:
+    /**
+     * 构造函数
+     * @param renderer 渲染器，渲染线程运行期间由本类负责同步访问
+     */
+    explicit SRenderThread(SCairoRenderer* renderer);
+
+    /**
+     * 析构函数
+     * 停止并等待渲染线程退出
+     */
+    ~SRenderThread();
+
+    SRenderThread(const SRenderThread&) = delete;
+    SRenderThread& operator=(const SRenderThread&) = delete;
+
+    /**
+     * 提交帧快照
+     * @param snapshot 帧快照，所有权转移给渲染线程
+     */
+    void commit(FrameSnapshot snapshot);
+
+    /**
+     * 调整渲染器大小（与渲染线程同步）
+     */
+    void resizeRenderer(int width, int height);
+
+    /**
+     * 等待渲染线程处理完所有已提交的快照
+     */
+    void waitIdle();
+
+    /** 已光栅化并呈现的帧数 */
+    uint64_t getRasterizedFrames() const;
+
+    /** 因被新快照覆盖而丢弃的帧数 */
+    uint64_t getDroppedFrames() const;
+
+private:
+    void threadMain();
+    void rasterize(const FrameSnapshot& snapshot);
+
+    SCairoRenderer* m_renderer;
+
+    // 保护渲染器（后缓冲和前缓冲）的访问
+    std::mutex m_rendererMutex;
+
+    // 保护待处理快照和退出标记
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    FrameSnapshot m_pending;
+    std::condition_variable m_idleCv;
+    bool m_hasPending = false;
+    bool m_busy = false; // 正在光栅化
+    bool m_stop = false;
+
+    uint64_t m_rasterizedFrames = 0;
+    uint64_t m_droppedFrames = 0;
+
+    std::thread m_thread;
+};
+
+} // namespace sgui
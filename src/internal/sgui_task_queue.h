@@ -0,0 +1,69 @@
+/**
+ * UI任务队列
+ *
+ * 多生产者单消费者（MPSC）无锁队列，任意线程投递任务，
+ * 由主线程在每次主循环迭代时统一执行
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace sgui {
+
+/**
+ * 无锁MPSC任务队列（Vyukov侵入式链表队列）
+ *
+ * push可以在任意线程并发调用，drain只能在主线程调用
+ */
+class STaskQueue {
+public:
+    using Task = std::function<void()>;
+
+    STaskQueue();
+    ~STaskQueue();
+
+    STaskQueue(const STaskQueue&) = delete;
+    STaskQueue& operator=(const STaskQueue&) = delete;
+
+    /**
+     * 投递任务（线程安全）
+     * @param task 任务
+     * @return 需要唤醒消费者时返回true；自上次drain以来已有投递者负责唤醒时返回false，
+     *         这样大量投递只会产生一次唤醒
+     */
+    bool push(Task task);
+
+    /**
+     * 执行当前队列中的所有任务（仅主线程）
+     * @return 执行的任务数
+     *
+     * 只执行调用时已经入队的任务，任务中再投递的任务留到下一次drain，避免无限循环
+     */
+    size_t drain();
+
+    /**
+     * 队列中是否有待执行的任务（仅主线程，结果是近似值）
+     */
+    bool empty() const;
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        Task task;
+    };
+
+    bool pop(Task& task);
+
+    std::atomic<Node*> m_head; // 生产者端
+    Node* m_tail;              // 消费者端
+    Node m_stub;
+
+    std::atomic<uint64_t> m_pushed{0};
+    uint64_t m_popped = 0;
+    std::atomic<bool> m_wakeupPending{false};
+};
+
+} // namespace sgui
@@ -0,0 +1,101 @@
+/**
+ * X11共享内存（MIT-SHM）呈现器
+ *
+ * 后缓冲的像素存放在SysV共享内存段中，并由X服务器映射，
+ * 呈现时用XShmPutImage直接让服务器读取共享内存，不再通过X socket传输像素。
+ * 服务器读取完成后发送ShmCompletion事件，在此之前不能修改后缓冲。
+ */
+
+#pragma once
+
+#ifdef SGUI_HAVE_XSHM
+
+#include <cairo/cairo.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sgui {
+
+/**
+ * 共享内存呈现器类
+ *
+ * 只支持32位/像素、颜色掩码与CAIRO_FORMAT_ARGB32一致的TrueColor视觉，
+ * 其他情况create()返回nullptr，由调用者回退到xlib surface呈现
+ */
+class SXShmPresenter {
+public:
+    /**
+     * 创建共享内存呈现器
+     * @param display X连接
+     * @param drawable 呈现的目标窗口
+     * @param visual 窗口的视觉
+     * @param depth 窗口的颜色深度
+     * @return 服务器不支持MIT-SHM、视觉格式不兼容或共享内存分配失败时返回nullptr
+     */
+    static std::unique_ptr<SXShmPresenter> create(::Display* display, ::Drawable drawable, ::Visual* visual,
+                                                  int depth, int width, int height);
+
+    /**
+     * 析构函数
+     * 等待未完成的呈现后从服务器分离并释放共享内存
+     */
+    ~SXShmPresenter();
+
+    SXShmPresenter(const SXShmPresenter&) = delete;
+    SXShmPresenter& operator=(const SXShmPresenter&) = delete;
+
+    /**
+     * 共享内存中的像素数据，可以用于创建cairo图像表面
+     */
+    unsigned char* getData() const;
+    int getStride() const;
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+
+    /**
+     * 把共享内存中的矩形呈现到窗口，请求完成事件后立即返回
+     */
+    void present(const std::vector<cairo_rectangle_int_t>& rects);
+
+    /**
+     * 等待所有已提交的呈现完成，之后可以安全地修改共享内存
+     */
+    void waitIdle();
+
+    /**
+     * 已收到完成事件的呈现数
+     */
+    uint64_t getCompletedCount() const { return m_completed; }
+
+private:
+    SXShmPresenter() = default;
+
+    ::Display* m_display = nullptr;
+    ::Drawable m_drawable = 0;
+    ::GC m_gc = nullptr;
+    XShmSegmentInfo m_shmInfo{};
+    XImage* m_image = nullptr;
+    bool m_attached = false;
+    int m_completionType = 0; // ShmCompletion事件类型
+    int m_width = 0;
+    int m_height = 0;
+    int m_pending = 0;        // 尚未完成的XShmPutImage数
+    uint64_t m_completed = 0;
+};
+
+} // namespace sgui
+
+#else
+
+namespace sgui {
+
+// 未启用MIT-SHM时只提供空定义，渲染器总是使用xlib surface呈现
+class SXShmPresenter {};
+
+} // namespace sgui
+
+#endif // SGUI_HAVE_XSHM
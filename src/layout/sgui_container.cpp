@@ -3,6 +3,8 @@
  */
 
 #include "sgui_container.h"
+#include "sgui_gradient_cache.h"
+#include "sgui_image_cache.h"
 #include <algorithm>
 #include <cmath>
 #include <iostream>
@@ -27,6 +29,9 @@ SContainer::~SContainer()
 {
     // 清理背景资源
     cleanupBackgroundSource();
+    cancelBackgroundImageRequest();
+    releaseGradientPattern();
+    releaseRoundedRectanglePaths();
 }
 
 // ====================================================================
@@ -41,8 +46,26 @@ void SContainer::setBackgroundColor(const Color &color)
 
 void SContainer::setBackgroundImage(const std::string &imagePath)
 {
+    if (imagePath != m_backgroundImage)
+    {
+        cancelBackgroundImageRequest();
+    }
     m_backgroundImage = imagePath;
     m_hasBackgroundImage = !imagePath.empty();
+
+    // 提前在后台预取，第一次绘制时图像可能已经解码完成
+    if (m_hasBackgroundImage && !m_imageRequest && SImageCache::instance().isAsyncDecode())
+    {
+        cairo_surface_t *cached = SImageCache::instance().lookup(m_backgroundImage);
+        if (cached)
+        {
+            cairo_surface_destroy(cached);
+        }
+        else
+        {
+            requestBackgroundImage(ImageDecodePriority::Prefetch);
+        }
+    }
     markStylesDirty();
 }
 
@@ -50,6 +73,7 @@ void SContainer::setBackgroundGradient(const BackgroundGradient &gradient)
 {
     m_backgroundGradient = gradient;
     m_hasBackgroundGradient = !gradient.stops.empty();
+    releaseGradientPattern();
     markStylesDirty();
 }
 
@@ -57,7 +81,9 @@ void SContainer::clearBackground()
 {
     m_backgroundColor = Color(1, 1, 1, 0); // 透明背景
     m_backgroundImage.clear();
+    cancelBackgroundImageRequest();
     m_backgroundGradient.stops.clear();
+    releaseGradientPattern();
     m_hasBackgroundImage = false;
     m_hasBackgroundGradient = false;
     markStylesDirty();
@@ -82,6 +108,7 @@ void SContainer::setBorderStyle(BorderStyle style)
 void SContainer::setBorderRadius(const EdgeInsets &radius)
 {
     m_borderRadius = radius;
+    releaseRoundedRectanglePaths();
     markStylesDirty();
 }
 
@@ -89,6 +116,7 @@ void SContainer::setBoxShadow(const BoxShadow &shadow)
 {
     m_boxShadow = shadow;
     markStylesDirty();
+    invalidatePaintBounds();
 }
 
 void SContainer::clearBorderStyle()
@@ -96,8 +124,10 @@ void SContainer::clearBorderStyle()
     m_borderColor = Color(0, 0, 0, 0); //透明边框
     m_borderStyle = BorderStyle::Solid;
     m_borderRadius = EdgeInsets();
+    releaseRoundedRectanglePaths();
     m_boxShadow = BoxShadow();
     markStylesDirty();
+    invalidatePaintBounds();
 }
 
 // ====================================================================
@@ -214,6 +244,12 @@ void SContainer::render(cairo_t *cr)
     // 绘制背景
     drawBackgroundCairo(cr, x, y, width, height);
 
+    // 绘制内阴影（外阴影在renderOutset中绘制）
+    if (m_boxShadow.inset && hasVisibleBoxShadow())
+    {
+        drawInsetShadowCairo(cr, x, y, width, height);
+    }
+
     // 绘制边框
     drawBorderCairo(cr, x, y, width, height);
 
@@ -224,6 +260,52 @@ void SContainer::render(cairo_t *cr)
     cairo_restore(cr);
 }
 
+void SContainer::renderOutset(cairo_t *cr)
+{
+    float width = getLayoutWidth();
+    float height = getLayoutHeight();
+    if (!cr || width <= 0 || height <= 0 || m_boxShadow.inset || !hasVisibleBoxShadow())
+        return;
+
+    double shapeX, shapeY;
+    ShadowShape shape = makeShadowShape(0, 0, width, height, shapeX, shapeY);
+
+    cairo_save(cr);
+
+    // 外阴影只出现在盒子外面：按奇偶规则裁剪掉盒子内部
+    Rect bounds = getPaintBounds();
+    cairo_rectangle(cr, bounds.x - 1, bounds.y - 1, bounds.width + 2, bounds.height + 2);
+    createComplexRoundedRectanglePath(cr, 0, 0, width, height);
+    cairo_set_fill_rule(cr, CAIRO_FILL_RULE_EVEN_ODD);
+    cairo_clip(cr);
+
+    // 模糊后的遮罩来自全局阴影缓存，颜色作为源在绘制时指定
+    cairo_set_source_rgba(cr, m_boxShadow.color.r, m_boxShadow.color.g, m_boxShadow.color.b, m_boxShadow.color.a);
+    SShadowCache::instance().draw(cr, shape, shapeX, shapeY);
+
+    cairo_restore(cr);
+}
+
+Rect SContainer::getPaintBounds() const
+{
+    Rect bounds = SLayout::getPaintBounds();
+    if (m_boxShadow.inset || !hasVisibleBoxShadow())
+        return bounds;
+
+    // 外阴影的范围：扩散后的盒子加上模糊范围
+    double shapeX, shapeY;
+    ShadowShape shape = makeShadowShape(0, 0, static_cast<float>(bounds.width), static_cast<float>(bounds.height), shapeX, shapeY);
+    if (shape.width <= 0 || shape.height <= 0)
+        return bounds;
+
+    double margin = SShadowCache::blurExtent(shape.blurRadius);
+    double x0 = std::min(bounds.x, shapeX - margin);
+    double y0 = std::min(bounds.y, shapeY - margin);
+    double x1 = std::max(bounds.x + bounds.width, shapeX + shape.width + margin);
+    double y1 = std::max(bounds.y + bounds.height, shapeY + shape.height + margin);
+    return Rect(x0, y0, x1 - x0, y1 - y0);
+}
+
 void SContainer::onMeasure(float width, float height, float &measuredWidth, float &measuredHeight)
 {
     measuredWidth = 0;
@@ -403,6 +485,31 @@ void SContainer::createRoundedRectanglePath(cairo_t *cr, float x, float y, float
 // 创建复杂圆角矩形路径（支持不同方向的圆角）
 void SContainer::createComplexRoundedRectanglePath(cairo_t *cr, float x, float y, float width, float height)
 {
+    const cairo_path_t *path = getRoundedRectanglePath(width, height);
+    if (!path)
+        return;
+
+    // 缓存的路径原点在(0, 0)，追加时按当前变换转换到设备坐标
+    cairo_translate(cr, x, y);
+    cairo_append_path(cr, path);
+    cairo_translate(cr, -x, -y);
+}
+
+const cairo_path_t *SContainer::getRoundedRectanglePath(float width, float height)
+{
+    for (const RoundedPathEntry &entry : m_roundedPaths)
+    {
+        if (entry.path && entry.width == width && entry.height == height)
+            return entry.path;
+    }
+
+    // 在单位矩阵的临时上下文中构建路径，不影响调用者上下文中已有的路径
+    static thread_local cairo_surface_t *scratchSurface = cairo_image_surface_create(CAIRO_FORMAT_A8, 1, 1);
+    static thread_local cairo_t *cr = cairo_create(scratchSurface);
+    cairo_new_path(cr);
+
+    const float x = 0.0f;
+    const float y = 0.0f;
     float radiusTL = m_borderRadius.top.value;
     float radiusTR = m_borderRadius.right.value;
     float radiusBR = m_borderRadius.bottom.value;
@@ -448,55 +555,88 @@ void SContainer::createComplexRoundedRectanglePath(cairo_t *cr, float x, float y
     }
 
     cairo_close_path(cr);
+
+    cairo_path_t *path = cairo_copy_path(cr);
+    cairo_new_path(cr);
+    if (!path || path->status != CAIRO_STATUS_SUCCESS)
+    {
+        if (path)
+            cairo_path_destroy(path);
+        return nullptr;
+    }
+
+    RoundedPathEntry &entry = m_roundedPaths[m_nextRoundedPath];
+    m_nextRoundedPath = (m_nextRoundedPath + 1) % kRoundedPathSlots;
+    if (entry.path)
+        cairo_path_destroy(entry.path);
+    entry.width = width;
+    entry.height = height;
+    entry.path = path;
+    return path;
+}
+
+void SContainer::releaseRoundedRectanglePaths()
+{
+    for (RoundedPathEntry &entry : m_roundedPaths)
+    {
+        if (entry.path)
+        {
+            cairo_path_destroy(entry.path);
+            entry.path = nullptr;
+        }
+    }
+    m_nextRoundedPath = 0;
 }
 
 // 设置背景源
-void SContainer::setupBackgroundSource(cairo_t *cr, float x, float y, float width, float height)
+bool SContainer::setupBackgroundSource(cairo_t *cr, float x, float y, float width, float height)
 {
     if (m_hasBackgroundGradient && !m_backgroundGradient.stops.empty())
     {
-        // 简单的线性渐变实现（后续可以扩展为更复杂的渐变）
-        cairo_pattern_t *gradient = cairo_pattern_create_linear(x, y, x + width, y + height);
-
-        for (const auto &stop : m_backgroundGradient.stops)
+        // 渐变图案按样式和区域尺寸编译一次，相同的渐变在所有节点间共享
+        if (!m_gradientPattern || m_gradientWidth != width || m_gradientHeight != height)
         {
-            cairo_pattern_add_color_stop_rgba(gradient, stop.position, stop.color.r, stop.color.g, stop.color.b, stop.color.a);
+            releaseGradientPattern();
+            m_gradientPattern = SGradientCache::instance().acquire(m_backgroundGradient, width, height);
+            m_gradientWidth = width;
+            m_gradientHeight = height;
         }
 
-        cairo_set_source(cr, gradient);
-        m_currentPattern = gradient;
+        // 图案定义在区域局部坐标系中，设置源时锁定平移后的用户坐标系
+        cairo_translate(cr, x, y);
+        cairo_set_source(cr, m_gradientPattern);
+        cairo_translate(cr, -x, -y);
+        return true;
     }
-    else if (m_hasBackgroundImage && !m_backgroundImage.empty())
+
+    if (m_hasBackgroundImage && !m_backgroundImage.empty())
     {
-        // 实现图片背景绘制
-        // 检查图片路径是否有效
-        if (!m_backgroundImage.empty())
+        // 图片背景：表面来自全局图像缓存；异步解码完成前先绘制背景色
+        cairo_surface_t *image_surface = acquireBackgroundImage();
+        if (image_surface)
         {
-            // 尝试加载图片并创建Cairo表面
-            cairo_surface_t *image_surface = cairo_image_surface_create_from_png(m_backgroundImage.c_str());
-            if (cairo_surface_status(image_surface) == CAIRO_STATUS_SUCCESS)
-            {
-                // 创建图片图案
-                cairo_pattern_t *pattern = cairo_pattern_create_for_surface(image_surface);
+            // 创建图片图案
+            cairo_pattern_t *pattern = cairo_pattern_create_for_surface(image_surface);
 
-                // 设置图片缩放模式
-                cairo_pattern_set_extend(pattern, CAIRO_EXTEND_REPEAT);
+            // 设置图片缩放模式
+            cairo_pattern_set_extend(pattern, CAIRO_EXTEND_REPEAT);
 
-                cairo_set_source(cr, pattern);
-                m_currentPattern = pattern;
-                m_currentSurface = image_surface;
-            }else{
-                std::cerr << "Failed to load background image: " << m_backgroundImage << std::endl;
-            }
+            cairo_set_source(cr, pattern);
+            m_currentPattern = pattern;
+            m_currentSurface = image_surface;
+            return true;
         }
     }
-    else if (m_backgroundColor.a > 0)
+
+    if (m_backgroundColor.a > 0)
     {
         // 纯色背景
         cairo_set_source_rgba(cr, m_backgroundColor.r, m_backgroundColor.g, m_backgroundColor.b, m_backgroundColor.a);
         m_currentPattern = nullptr;
         m_currentSurface = nullptr;
+        return true;
     }
+    return false;
 }
 
 // 清理背景资源
@@ -514,6 +654,101 @@ void SContainer::cleanupBackgroundSource()
     }
 }
 
+cairo_surface_t *SContainer::acquireBackgroundImage()
+{
+    SImageCache &cache = SImageCache::instance();
+    if (!cache.isAsyncDecode() && !m_imageRequest)
+    {
+        cairo_surface_t *surface = cache.acquire(m_backgroundImage);
+        if (!surface)
+        {
+            std::cerr << "Failed to load background image: " << m_backgroundImage << std::endl;
+        }
+        return surface;
+    }
+
+    if (m_imageRequest)
+    {
+        if (!m_imageRequest->isDone())
+        {
+            // 当前帧需要这个图像，提高解码优先级
+            m_imageRequest->setPriority(ImageDecodePriority::Visible);
+            return nullptr;
+        }
+        cairo_surface_t *surface = m_imageRequest->getSurface();
+        if (!surface)
+        {
+            // 解码失败时保留请求，避免每次绘制都重新请求
+            return nullptr;
+        }
+
+        // 解码结果已经进入缓存时不再持有请求，之后回到按路径和修改时间查找缓存，文件被修改后会重新解码；
+        // 超过缓存预算的图像只能使用请求中的结果。
+        // 工作线程设置完成标志后回调才投递到UI线程，此时回调可能还在队列中，丢弃前先取消
+        cairo_surface_t *cached = cache.lookup(m_backgroundImage);
+        if (cached)
+        {
+            cancelBackgroundImageRequest();
+            return cached;
+        }
+        return cairo_surface_reference(surface);
+    }
+
+    cairo_surface_t *surface = cache.lookup(m_backgroundImage);
+    if (!surface)
+    {
+        requestBackgroundImage(ImageDecodePriority::Visible);
+    }
+    return surface;
+}
+
+void SContainer::requestBackgroundImage(ImageDecodePriority priority)
+{
+    // 回调在UI线程执行；丢弃请求前（包括节点析构或被移除时）总是先取消，回调不会访问已经失效的节点。
+    // 回调只使用自己的请求，节点已经换成新请求时直接返回
+    auto token = std::make_shared<std::weak_ptr<SImageRequest>>();
+    m_imageRequest = SImageCache::instance().requestAsync(m_backgroundImage, priority, [this, token]() {
+        SImageRequestPtr request = token->lock();
+        if (!request || m_imageRequest != request)
+        {
+            return;
+        }
+        if (!request->getSurface())
+        {
+            std::cerr << "Failed to load background image: " << m_backgroundImage << std::endl;
+        }
+        markPaintDirty();
+    });
+    *token = m_imageRequest;
+}
+
+void SContainer::cancelBackgroundImageRequest()
+{
+    if (m_imageRequest)
+    {
+        m_imageRequest->cancel();
+        m_imageRequest.reset();
+    }
+}
+
+void SContainer::releaseGradientPattern()
+{
+    if (m_gradientPattern)
+    {
+        cairo_pattern_destroy(m_gradientPattern);
+        m_gradientPattern = nullptr;
+    }
+}
+
+void SContainer::onDetached()
+{
+    // 解码还没有完成时取消请求，重新加入控件树后绘制时会再次请求
+    if (m_imageRequest && !m_imageRequest->isDone())
+    {
+        cancelBackgroundImageRequest();
+    }
+}
+
 // 检查是否有圆角
 bool SContainer::hasBorderRadius() const
 {
@@ -540,8 +775,9 @@ void SContainer::drawBackgroundCairo(cairo_t *cr, float x, float y, float width,
     if (bgWidth <= 0 || bgHeight <= 0)
         return;
 
-    // 设置背景源
-    setupBackgroundSource(cr, bgX, bgY, bgWidth, bgHeight);
+    // 设置背景源，没有可绘制的背景（例如图像还在解码且背景色透明）时跳过
+    if (!setupBackgroundSource(cr, bgX, bgY, bgWidth, bgHeight))
+        return;
 
     // 使用统一的圆角路径（与边框一致）
     if (hasBorderRadius())
@@ -561,6 +797,69 @@ void SContainer::drawBackgroundCairo(cairo_t *cr, float x, float y, float width,
     cleanupBackgroundSource();
 }
 
+void SContainer::drawInsetShadowCairo(cairo_t *cr, float x, float y, float width, float height)
+{
+    // 内阴影限制在边框以内的区域，与背景一致
+    float areaX = x + getLayoutBorderLeft();
+    float areaY = y + getLayoutBorderTop();
+    float areaWidth = width - getLayoutBorderLeft() - getLayoutBorderRight();
+    float areaHeight = height - getLayoutBorderTop() - getLayoutBorderBottom();
+    if (areaWidth <= 0 || areaHeight <= 0)
+        return;
+
+    cairo_save(cr);
+    if (hasBorderRadius())
+    {
+        createComplexRoundedRectanglePath(cr, areaX, areaY, areaWidth, areaHeight);
+    }
+    else
+    {
+        cairo_rectangle(cr, areaX, areaY, areaWidth, areaHeight);
+    }
+    cairo_clip(cr);
+    cairo_set_source_rgba(cr, m_boxShadow.color.r, m_boxShadow.color.g, m_boxShadow.color.b, m_boxShadow.color.a);
+
+    double shapeX, shapeY;
+    ShadowShape shape = makeShadowShape(areaX, areaY, areaWidth, areaHeight, shapeX, shapeY);
+    if (shape.width <= 0 || shape.height <= 0)
+    {
+        // 扩散半径大于区域时整个区域都在阴影中
+        cairo_paint(cr);
+    }
+    else
+    {
+        SShadowCache::instance().draw(cr, shape, shapeX, shapeY);
+    }
+    cairo_restore(cr);
+}
+
+bool SContainer::hasVisibleBoxShadow() const
+{
+    return m_boxShadow.color.a > 0 &&
+           (m_boxShadow.blurRadius > 0 || m_boxShadow.spreadRadius != 0 || m_boxShadow.offsetX != 0 || m_boxShadow.offsetY != 0);
+}
+
+ShadowShape SContainer::makeShadowShape(float x, float y, float width, float height, double &shapeX, double &shapeY) const
+{
+    // 外阴影的圆角随扩散半径增大，内阴影的圆角随扩散半径减小
+    double spread = m_boxShadow.inset ? -m_boxShadow.spreadRadius : m_boxShadow.spreadRadius;
+    auto adjustRadius = [spread](float radius) { return radius > 0 ? std::max(0.0, radius + spread) : 0.0; };
+
+    ShadowShape shape;
+    shape.width = width + 2 * spread;
+    shape.height = height + 2 * spread;
+    shape.radiusTopLeft = adjustRadius(m_borderRadius.top.value);
+    shape.radiusTopRight = adjustRadius(m_borderRadius.right.value);
+    shape.radiusBottomRight = adjustRadius(m_borderRadius.bottom.value);
+    shape.radiusBottomLeft = adjustRadius(m_borderRadius.left.value);
+    shape.blurRadius = std::max(0.0f, m_boxShadow.blurRadius);
+    shape.inset = m_boxShadow.inset;
+
+    shapeX = x - spread + m_boxShadow.offsetX;
+    shapeY = y - spread + m_boxShadow.offsetY;
+    return shape;
+}
+
 void SContainer::drawBorderCairo(cairo_t *cr, float x, float y, float width, float height)
 {
     if (!hasBorderStyle())
@@ -838,8 +1137,9 @@ void SContainer::drawTextCairo(cairo_t *cr, float x, float y, float width, float
 void SContainer::markStylesDirty()
 {
     m_stylesDirty = true;
-    // 标记需要重新绘制
-    markDirty();
+    // 样式只影响绘制：容器没有设置Yoga测量函数，文本样式也不会改变布局，
+    // 因此只标记需要重绘，不触发布局计算
+    markPaintDirty();
 }
 
 } // namespace sgui
@@ -3,10 +3,13 @@
  */
 
 #include "sgui_layout.h"
+#include "sgui_layer_cache.h"
 #include <cairo.h>
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <cmath>
+#include <chrono>
 
 namespace sgui {
 
@@ -25,6 +28,44 @@ static YGSize measureFunc(YGNodeConstRef node, float width, YGMeasureMode widthM
     return {measuredWidth, measuredHeight};
 }
 
+// 自动提升为层的条件
+static constexpr int kAutoLayerCleanFrames = 2;        // 子树至少连续这么多帧没有变化
+static constexpr size_t kAutoLayerMinNodes = 16;       // 裁剪溢出的子树至少有这么多节点
+static constexpr double kAutoLayerMinCostUs = 500.0;   // 或者完整绘制子树至少耗时这么多微秒
+
+// 把浮点边界转换为整像素的损坏矩形，向外扩展1像素容纳抗锯齿边缘
+static cairo_rectangle_int_t toDamageRect(const Rect& rect) {
+    int x0 = static_cast<int>(std::floor(rect.x)) - 1;
+    int y0 = static_cast<int>(std::floor(rect.y)) - 1;
+    int x1 = static_cast<int>(std::ceil(rect.x + rect.width)) + 1;
+    int y1 = static_cast<int>(std::ceil(rect.y + rect.height)) + 1;
+    return {x0, y0, x1 - x0, y1 - y0};
+}
+
+static void addDamageRect(cairo_region_t* damage, const Rect& rect) {
+    cairo_rectangle_int_t r = toDamageRect(rect);
+    cairo_region_union_rectangle(damage, &r);
+}
+
+// 边界向外扩展1像素（抗锯齿边缘）后是否与裁剪矩形相交
+static bool intersectsClip(const Rect& clip, double x, double y, double width, double height) {
+    return !clip.isEmpty() &&
+           x - 1.0 < clip.x + clip.width && x + width + 1.0 > clip.x &&
+           y - 1.0 < clip.y + clip.height && y + height + 1.0 > clip.y;
+}
+
+// 范围（向内收缩1像素）是否完全在裁剪矩形内
+static bool containedInClip(const Rect& clip, double x, double y, double width, double height) {
+    return x + 1.0 >= clip.x && x + width - 1.0 <= clip.x + clip.width &&
+           y + 1.0 >= clip.y && y + height - 1.0 <= clip.y + clip.height;
+}
+
+// 布局版本号：任何节点的布局可能变化时递增，用来判断缓存的子树范围是否有效
+static uint64_t g_layoutVersion = 1;
+
+// 绘制帧号：每次从根节点绘制或记录控件树时递增，用来按帧统计子树没有变化的帧数
+static uint64_t g_paintFrame = 0;
+
 // 静态回调函数用于布局变化
 static void dirtiedFunc(YGNodeConstRef node) {
     SLayout* container = static_cast<SLayout*>(YGNodeGetContext(node));
@@ -48,6 +89,9 @@ SLayout::SLayout() {
 }
 
 SLayout::~SLayout() {
+    // 释放缓存的层
+    SLayerCache::instance().remove(this);
+
     // 移除所有子节点
     removeAllChildren();
     
@@ -81,7 +125,7 @@ void SLayout::addChild(const SLayoutPtr& child) {
     YGNodeInsertChild(m_yogaNode, child->m_yogaNode, YGNodeGetChildCount(m_yogaNode));
     
     // 标记需要重新计算布局
-    markDirty();
+    markLayoutDirty();
 }
 
 void SLayout::insertChild(const SLayoutPtr& child, size_t index) {
@@ -103,7 +147,7 @@ void SLayout::insertChild(const SLayoutPtr& child, size_t index) {
     YGNodeInsertChild(m_yogaNode, child->m_yogaNode, index);
     
     // 标记需要重新计算布局
-    markDirty();
+    markLayoutDirty();
 }
 
 void SLayout::removeChild(const SLayoutPtr& child) {
@@ -114,14 +158,20 @@ void SLayout::removeChild(const SLayoutPtr& child) {
         // 从Yoga节点树移除
         YGNodeRemoveChild(m_yogaNode, child->m_yogaNode);
         
+        // 被移除的子树原来占据的区域需要重绘
+        child->takePaintedBounds(m_removedDamage);
+        
         // 清除父节点引用
         child->m_parent.reset();
         
         // 从子节点列表移除
         m_children.erase(it);
+
+        // 通知被移除的子树取消后台任务
+        child->notifyDetached();
         
         // 标记需要重新计算布局
-        markDirty();
+        markLayoutDirty();
     }
 }
 
@@ -129,16 +179,21 @@ void SLayout::removeAllChildren() {
     // 移除所有Yoga子节点
     YGNodeRemoveAllChildren(m_yogaNode);
     
-    // 清除所有子节点的父节点引用
+    // 清除所有子节点的父节点引用，并记录它们原来占据的区域
     for (auto& child : m_children) {
+        child->takePaintedBounds(m_removedDamage);
         child->m_parent.reset();
     }
     
-    // 清空子节点列表
-    m_children.clear();
+    // 清空子节点列表，并通知被移除的子树取消后台任务
+    std::vector<SLayoutPtr> removed;
+    removed.swap(m_children);
+    for (auto& child : removed) {
+        child->notifyDetached();
+    }
     
     // 标记需要重新计算布局
-    markDirty();
+    markLayoutDirty();
 }
 
 size_t SLayout::getChildCount() const {
@@ -164,6 +219,7 @@ void SLayout::setWidth(const LayoutValue& width) {
     } else {
         YGNodeStyleSetWidth(m_yogaNode, ygValue.value);
     }
+    markLayoutDirty();
 }
 
 void SLayout::setHeight(const LayoutValue& height) {
@@ -175,6 +231,7 @@ void SLayout::setHeight(const LayoutValue& height) {
     } else {
         YGNodeStyleSetHeight(m_yogaNode, ygValue.value);
     }
+    markLayoutDirty();
 }
 
 void SLayout::setMinWidth(const LayoutValue& minWidth) {
@@ -184,6 +241,7 @@ void SLayout::setMinWidth(const LayoutValue& minWidth) {
     } else {
         YGNodeStyleSetMinWidth(m_yogaNode, ygValue.value);
     }
+    markLayoutDirty();
 }
 
 void SLayout::setMinHeight(const LayoutValue& minHeight) {
@@ -193,6 +251,7 @@ void SLayout::setMinHeight(const LayoutValue& minHeight) {
     } else {
         YGNodeStyleSetMinHeight(m_yogaNode, ygValue.value);
     }
+    markLayoutDirty();
 }
 
 void SLayout::setMaxWidth(const LayoutValue& maxWidth) {
@@ -202,6 +261,7 @@ void SLayout::setMaxWidth(const LayoutValue& maxWidth) {
     } else {
         YGNodeStyleSetMaxWidth(m_yogaNode, ygValue.value);
     }
+    markLayoutDirty();
 }
 
 void SLayout::setMaxHeight(const LayoutValue& maxHeight) {
@@ -211,6 +271,7 @@ void SLayout::setMaxHeight(const LayoutValue& maxHeight) {
     } else {
         YGNodeStyleSetMaxHeight(m_yogaNode, ygValue.value);
     }
+    markLayoutDirty();
 }
 
 LayoutValue SLayout::getWidth() const {
@@ -240,14 +301,17 @@ LayoutValue SLayout::getMaxHeight() const {
 // --- Flex属性 ---
 void SLayout::setFlex(float flex) {
     YGNodeStyleSetFlex(m_yogaNode, flex);
+    markLayoutDirty();
 }
 
 void SLayout::setFlexGrow(float flexGrow) {
     YGNodeStyleSetFlexGrow(m_yogaNode, flexGrow);
+    markLayoutDirty();
 }
 
 void SLayout::setFlexShrink(float flexShrink) {
     YGNodeStyleSetFlexShrink(m_yogaNode, flexShrink);
+    markLayoutDirty();
 }
 
 void SLayout::setFlexBasis(const LayoutValue& flexBasis) {
@@ -259,6 +323,7 @@ void SLayout::setFlexBasis(const LayoutValue& flexBasis) {
     } else {
         YGNodeStyleSetFlexBasis(m_yogaNode, ygValue.value);
     }
+    markLayoutDirty();
 }
 
 float SLayout::getFlex() const {
@@ -280,22 +345,27 @@ LayoutValue SLayout::getFlexBasis() const {
 // --- 布局方向和对齐 ---
 void SLayout::setFlexDirection(FlexDirection direction) {
     YGNodeStyleSetFlexDirection(m_yogaNode, static_cast<YGFlexDirection>(static_cast<int>(direction)));
+    markLayoutDirty();
 }
 
 void SLayout::setJustifyContent(Align justify) {
     YGNodeStyleSetJustifyContent(m_yogaNode, static_cast<YGJustify>(static_cast<int>(justify)));
+    markLayoutDirty();
 }
 
 void SLayout::setAlignItems(Align align) {
     YGNodeStyleSetAlignItems(m_yogaNode, static_cast<YGAlign>(static_cast<int>(align)));
+    markLayoutDirty();
 }
 
 void SLayout::setAlignSelf(Align align) {
     YGNodeStyleSetAlignSelf(m_yogaNode, static_cast<YGAlign>(static_cast<int>(align)));
+    markLayoutDirty();
 }
 
 void SLayout::setAlignContent(Align align) {
     YGNodeStyleSetAlignContent(m_yogaNode, static_cast<YGAlign>(static_cast<int>(align)));
+    markLayoutDirty();
 }
 
 FlexDirection SLayout::getFlexDirection() const {
@@ -321,10 +391,12 @@ Align SLayout::getAlignContent() const {
 // --- 位置和定位 ---
 void SLayout::setPosition(PositionType positionType) {
     YGNodeStyleSetPositionType(m_yogaNode, static_cast<YGPositionType>(positionType));
+    markLayoutDirty();
 }
 
 void SLayout::setPosition(EdgeInsets position) {
     setPositionValues(position);
+    markLayoutDirty();
 }
 
 PositionType SLayout::getPositionType() const {
@@ -341,10 +413,12 @@ EdgeInsets SLayout::getPosition() const {
 // --- 边距和内边距 ---
 void SLayout::setMargin(const EdgeInsets& margin) {
     setEdgeValues(YGNodeStyleSetMargin, YGNodeStyleSetMarginPercent, margin);
+    markLayoutDirty();
 }
 
 void SLayout::setPadding(const EdgeInsets& padding) {
     setEdgeValues(YGNodeStyleSetPadding, YGNodeStyleSetPaddingPercent, padding);
+    markLayoutDirty();
 }
 
 void SLayout::setBorder(const EdgeInsets& border) {
@@ -352,6 +426,7 @@ void SLayout::setBorder(const EdgeInsets& border) {
     YGNodeStyleSetBorder(m_yogaNode, YGEdgeTop, border.top.value);
     YGNodeStyleSetBorder(m_yogaNode, YGEdgeRight, border.right.value);
     YGNodeStyleSetBorder(m_yogaNode, YGEdgeBottom, border.bottom.value);
+    markLayoutDirty();
 }
 
 EdgeInsets SLayout::getMargin() const {
@@ -375,22 +450,27 @@ EdgeInsets SLayout::getBorder() const {
 // --- 其他属性 ---
 void SLayout::setFlexWrap(FlexWrap wrap) {
     YGNodeStyleSetFlexWrap(m_yogaNode, static_cast<YGWrap>(static_cast<int>(wrap)));
+    markLayoutDirty();
 }
 
 void SLayout::setOverflow(Overflow overflow) {
     YGNodeStyleSetOverflow(m_yogaNode, static_cast<YGOverflow>(static_cast<int>(overflow)));
+    markLayoutDirty();
 }
 
 void SLayout::setDisplay(Display display) {
     YGNodeStyleSetDisplay(m_yogaNode, static_cast<YGDisplay>(static_cast<int>(display)));
+    markLayoutDirty();
 }
 
 void SLayout::setAspectRatio(float aspectRatio) {
     YGNodeStyleSetAspectRatio(m_yogaNode, aspectRatio);
+    markLayoutDirty();
 }
 
 void SLayout::setDirection(Direction direction) {
     YGNodeStyleSetDirection(m_yogaNode, static_cast<YGDirection>(static_cast<int>(direction)));
+    markLayoutDirty();
 }
 
 // ====================================================================
@@ -405,7 +485,7 @@ void SLayout::setGap(Gutter gutter, const LayoutValue& gap) {
     } else {
         YGNodeStyleSetGap(m_yogaNode, ygGutter, gap.value);
     }
-    markDirty();
+    markLayoutDirty();
 }
 
 void SLayout::setColumnGap(const LayoutValue& gap) {
@@ -426,7 +506,7 @@ void SLayout::setGapAll(const LayoutValue& gap) {
 
 void SLayout::setBoxSizing(BoxSizing boxSizing) {
     YGNodeStyleSetBoxSizing(m_yogaNode, static_cast<YGBoxSizing>(static_cast<int>(boxSizing)));
-    markDirty();
+    markLayoutDirty();
 }
 
 // ====================================================================
@@ -484,6 +564,7 @@ Direction SLayout::getDirection() const {
 // ====================================================================
 
 void SLayout::calculateLayout(float width, float height) {
+    g_layoutVersion++;
     YGNodeCalculateLayout(m_yogaNode, width, height, YGDirectionLTR);
 }
 
@@ -495,6 +576,23 @@ float SLayout::getTop() const {
     return YGNodeLayoutGetTop(m_yogaNode);
 }
 
+void SLayout::getAbsolutePosition(float& x, float& y) const {
+    x = getLeft();
+    y = getTop();
+    for (auto parent = getParent(); parent; parent = parent->getParent()) {
+        x += parent->getLeft();
+        y += parent->getTop();
+    }
+}
+
+const SLayout* SLayout::getRoot() const {
+    const SLayout* node = this;
+    for (auto parent = node->getParent(); parent; parent = parent->getParent()) {
+        node = parent.get();
+    }
+    return node;
+}
+
 float SLayout::getRight() const {
     return YGNodeLayoutGetRight(m_yogaNode);
 }
@@ -561,16 +659,67 @@ float SLayout::getLayoutBorderBottom() const {
 
 bool SLayout::isDirty() const {
     // return YGNodeIsDirty(m_yogaNode);
-    return m_dirty;
+    return m_layoutDirty || m_subtreePaintDirty;
 }
 
 void SLayout::markDirty() {
-    // YGNodeMarkDirty(m_yogaNode);
-    m_dirty = true;
+    markLayoutDirty();
 }
 
 void SLayout::clearDirty() {
-    m_dirty = false;
+    clearLayoutDirty();
+    clearPaintDirty();
+}
+
+void SLayout::markLayoutDirty() {
+    // 布局变化后节点位置和尺寸都可能改变，同时需要重绘
+    g_layoutVersion++;
+    markPaintDirty();
+
+    // 向上传播，直到遇到已经标记过的祖先
+    SLayout* node = this;
+    while (node && !node->m_layoutDirty) {
+        node->m_layoutDirty = true;
+        auto parent = node->getParent();
+        node = parent.get();
+    }
+}
+
+void SLayout::markPaintDirty() {
+    m_paintDirty = true;
+    m_recordingValid = false;
+
+    // 向上传播子树需要重绘的标记，直到遇到已经标记过的祖先；
+    // 同时使路径上的层失效，子树在本帧被剔除、标记被清除后也不会再贴出旧的层
+    m_layerValid = false;
+    SLayout* node = this;
+    while (node && !node->m_subtreePaintDirty) {
+        node->m_subtreePaintDirty = true;
+        node->m_layerValid = false;
+        auto parent = node->getParent();
+        node = parent.get();
+    }
+}
+
+void SLayout::clearLayoutDirty() {
+    if (!m_layoutDirty) {
+        return;
+    }
+    m_layoutDirty = false;
+    for (auto& child : m_children) {
+        child->clearLayoutDirty();
+    }
+}
+
+void SLayout::clearPaintDirty() {
+    if (!m_subtreePaintDirty) {
+        return;
+    }
+    m_paintDirty = false;
+    m_subtreePaintDirty = false;
+    for (auto& child : m_children) {
+        child->clearPaintDirty();
+    }
 }
 
 
@@ -580,39 +729,473 @@ void SLayout::clearDirty() {
 
 void SLayout::renderTree(cairo_t* cr) {
     if (!cr) return;
-    
-    // 保存当前状态
-    cairo_save(cr);
-    
+    m_renderStats = RenderStats();
+    g_paintFrame++;
+    renderTreeImpl(cr, nullptr, 0.0f, 0.0f, true, m_renderStats);
+}
+
+void SLayout::renderTree(cairo_t* cr, const cairo_region_t* damage) {
+    if (!cr) return;
+    m_renderStats = RenderStats();
+    g_paintFrame++;
+    renderTreeImpl(cr, damage, 0.0f, 0.0f, true, m_renderStats);
+}
+
+size_t SLayout::renderTreeImpl(cairo_t* cr, const cairo_region_t* damage, float originX, float originY, bool allowLayer,
+                              RenderStats& stats) {
     // 获取布局信息
     // left/top/... 已经计算包含了 margin
     float left = getLeft();
     float top = getTop();
     float width = getLayoutWidth();
     float height = getLayoutHeight();
+    float x = originX + left;
+    float y = originY + top;
+
+    // 当前裁剪范围（父节点坐标系），包括调用者设置的损坏区域裁剪和祖先的溢出裁剪
+    double clipX0, clipY0, clipX1, clipY1;
+    cairo_clip_extents(cr, &clipX0, &clipY0, &clipX1, &clipY1);
+    Rect clip(clipX0, clipY0, clipX1 - clipX0, clipY1 - clipY0);
+
+    // 子树范围在裁剪范围或损坏区域之外时跳过整棵子树
+    const Rect& subtree = getSubtreeBounds();
+    bool subtreeVisible = intersectsClip(clip, left + subtree.x, top + subtree.y, subtree.width, subtree.height);
+    if (subtreeVisible && damage) {
+        cairo_rectangle_int_t box = toDamageRect(Rect(x + subtree.x, y + subtree.y, subtree.width, subtree.height));
+        subtreeVisible = cairo_region_contains_rectangle(damage, &box) != CAIRO_REGION_OVERLAP_OUT;
+    }
+    if (!subtreeVisible) {
+        stats.culledNodes += m_subtreeCount;
+        return 0;
+    }
+
+    // 节点自身的绘制范围是否可见（在裁剪范围内并与损坏区域相交）
+    Rect paint = getPaintBounds();
+    bool intersects = intersectsClip(clip, left + paint.x, top + paint.y, paint.width, paint.height);
+    if (intersects && damage) {
+        cairo_rectangle_int_t box = toDamageRect(Rect(x + paint.x, y + paint.y, paint.width, paint.height));
+        intersects = cairo_region_contains_rectangle(damage, &box) != CAIRO_REGION_OVERLAP_OUT;
+    }
+    Overflow overflow = getOverflow();
+
+    // 子树没有变化的层直接贴图
+    if (allowLayer && shouldUseLayer() && drawLayer(cr, left, top)) {
+        stats.paintedNodes++;
+        return 1;
+    }
+
+    // 只有子树完整绘制（全部在裁剪范围和损坏区域内）时的耗时才能用来判断子树的绘制开销
+    bool measure = m_layerMode == LayerMode::Auto && !m_children.empty() &&
+                   containedInClip(clip, left + subtree.x, top + subtree.y, subtree.width, subtree.height);
+    if (measure && damage) {
+        cairo_rectangle_int_t box = toDamageRect(Rect(x + subtree.x, y + subtree.y, subtree.width, subtree.height));
+        measure = cairo_region_contains_rectangle(damage, &box) == CAIRO_REGION_OVERLAP_IN;
+    }
+    auto start = measure ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+    size_t painted = 0;
+    
+    // 保存当前状态
+    cairo_save(cr);
     
     // 移动到容器位置
     cairo_translate(cr, left, top);
     
-    // 设置裁剪区域（考虑溢出设置）
-    Overflow overflow = getOverflow();
+    // 绘制自定义controll：回放节点的绘制记录，节点有变化时才重新调用子类的render方法；
+    // 记录内部已经按溢出设置裁剪了节点自身的内容
+    if (intersects) {
+        getRecording(cairo_get_antialias(cr))->replay(cr);
+        painted++;
+        stats.paintedNodes++;
+    } else {
+        stats.culledNodes++;
+    }
+
+    // 设置子节点的裁剪区域（考虑溢出设置）
     if (overflow == Overflow::Hidden) {
         cairo_rectangle(cr, 0, 0, width, height);
         cairo_clip(cr);
     }
     
-    // 绘制自定义controll
-    render(cr); // 调用子类的render方法
-    
     // 遍历子节点
     for (const auto& child : m_children) {
         if (child->getDisplay() != Display::None) {
-            child->renderTree(cr);
+            painted += child->renderTreeImpl(cr, damage, x, y, true, stats);
         }
     }
     
     // 恢复状态
     cairo_restore(cr);
+
+    if (measure) {
+        m_paintCostUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+    return painted;
+}
+
+void SLayout::setLayerMode(LayerMode mode) {
+    m_layerMode = mode;
+    m_cleanFrames = 0;
+    if (mode == LayerMode::Never) {
+        SLayerCache::instance().remove(this);
+        m_layerValid = false;
+    }
+}
+
+bool SLayout::hasLayer() const {
+    return SLayerCache::instance().find(this) != nullptr;
+}
+
+bool SLayout::shouldUseLayer() {
+    if (m_layerMode == LayerMode::Always) {
+        return true;
+    }
+    if (m_layerMode == LayerMode::Never || m_children.empty() || !getParent()) {
+        // 根节点覆盖整个窗口，作为层只会多一次整窗口贴图
+        return false;
+    }
+
+    // 自动模式：内容频繁变化的子树缓存只会增加开销，连续几帧没有变化才提升为层；
+    // 同一帧内（例如重新渲染层时）多次调用只计一次
+    if (m_subtreePaintDirty) {
+        m_cleanFrames = 0;
+    } else if (m_cleanFrameNumber != g_paintFrame && m_cleanFrames < kAutoLayerCleanFrames) {
+        m_cleanFrames++;
+    }
+    m_cleanFrameNumber = g_paintFrame;
+
+    // 节点数来自子树范围计算时的统计，不依赖完整绘制
+    getSubtreeBounds();
+    bool promote = m_cleanFrames >= kAutoLayerCleanFrames &&
+                   ((getOverflow() == Overflow::Hidden && m_subtreeCount >= kAutoLayerMinNodes) ||
+                    m_paintCostUs >= kAutoLayerMinCostUs);
+    if (!promote && m_layerValid) {
+        // 不再作为层时及时释放缓存
+        SLayerCache::instance().remove(this);
+        m_layerValid = false;
+    }
+    return promote;
+}
+
+bool SLayout::drawLayer(cairo_t* cr, float left, float top) {
+    // 层按设备像素缓存，只支持纯平移的变换
+    cairo_matrix_t matrix;
+    cairo_get_matrix(cr, &matrix);
+    if (matrix.xx != 1.0 || matrix.yy != 1.0 || matrix.xy != 0.0 || matrix.yx != 0.0) {
+        return false;
+    }
+
+    // 节点原点的设备坐标
+    double deviceX = left;
+    double deviceY = top;
+    cairo_user_to_device(cr, &deviceX, &deviceY);
+
+    double x, y;
+    cairo_surface_t* surface = acquireLayer(deviceX, deviceY, cairo_get_antialias(cr), x, y);
+    if (!surface) {
+        return false;
+    }
+
+    // 在设备坐标系中贴图，保留调用者的裁剪
+    cairo_save(cr);
+    cairo_identity_matrix(cr);
+    cairo_set_source_surface(cr, surface, x, y);
+    cairo_paint(cr);
+    cairo_restore(cr);
+    cairo_surface_destroy(surface);
+    return true;
+}
+
+cairo_surface_t* SLayout::acquireLayer(double deviceX, double deviceY, cairo_antialias_t antialias, double& x, double& y) {
+    // 分为整像素部分和亚像素相位
+    double baseX = std::floor(deviceX);
+    double baseY = std::floor(deviceY);
+    double phaseX = deviceX - baseX;
+    double phaseY = deviceY - baseY;
+    float width = getLayoutWidth();
+    float height = getLayoutHeight();
+
+    SLayerCache& cache = SLayerCache::instance();
+    const LayerEntry* entry = cache.find(this);
+    bool valid = entry && m_layerValid && !m_subtreePaintDirty &&
+                 entry->nodeWidth == width && entry->nodeHeight == height &&
+                 entry->phaseX == phaseX && entry->phaseY == phaseY;
+    if (valid) {
+        cache.touch(this);
+        x = baseX + entry->offsetX;
+        y = baseY + entry->offsetY;
+        return cairo_surface_reference(entry->surface);
+    }
+
+    // 层覆盖整棵子树，向外扩展1像素容纳抗锯齿边缘
+    const Rect& bounds = getSubtreeBounds();
+    int offsetX = static_cast<int>(std::floor(phaseX + bounds.x)) - 1;
+    int offsetY = static_cast<int>(std::floor(phaseY + bounds.y)) - 1;
+    int layerWidth = static_cast<int>(std::ceil(phaseX + bounds.x + bounds.width)) + 1 - offsetX;
+    int layerHeight = static_cast<int>(std::ceil(phaseY + bounds.y + bounds.height)) + 1 - offsetY;
+
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, layerWidth, layerHeight);
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(surface);
+        return nullptr;
+    }
+
+    // 节点原点位于层表面的(phaseX - offsetX, phaseY - offsetY)，与直接绘制时的亚像素位置一致；
+    // renderTreeImpl会再平移getLeft/getTop，这里先抵消
+    cairo_t* layerCr = cairo_create(surface);
+    cairo_set_antialias(layerCr, antialias);
+    cairo_translate(layerCr, phaseX - offsetX - getLeft(), phaseY - offsetY - getTop());
+    RenderStats layerStats;
+    renderTreeImpl(layerCr, nullptr, 0.0f, 0.0f, false, layerStats);
+    cairo_destroy(layerCr);
+    cairo_surface_flush(surface);
+
+    x = baseX + offsetX;
+    y = baseY + offsetY;
+
+    LayerEntry newEntry;
+    newEntry.surface = cairo_surface_reference(surface);
+    newEntry.offsetX = offsetX;
+    newEntry.offsetY = offsetY;
+    newEntry.phaseX = phaseX;
+    newEntry.phaseY = phaseY;
+    newEntry.nodeWidth = width;
+    newEntry.nodeHeight = height;
+    newEntry.bytes = static_cast<size_t>(cairo_image_surface_get_stride(surface)) *
+                     cairo_image_surface_get_height(surface);
+    m_layerValid = cache.store(this, newEntry);
+    return surface;
+}
+
+const SRecordingPtr& SLayout::getRecording(cairo_antialias_t antialias) {
+    float width = getLayoutWidth();
+    float height = getLayoutHeight();
+    if (m_recording && m_recordingValid && m_recordingWidth == width && m_recordingHeight == height &&
+        m_recordingAntialias == antialias) {
+        return m_recording;
+    }
+
+    // 先标记为有效：render()中再次标记需要重绘时，下次使用会重新记录
+    m_recordingValid = true;
+    m_recordingWidth = width;
+    m_recordingHeight = height;
+    m_recordingAntialias = antialias;
+
+    // 不限制范围，节点可以绘制到自身边界以外（例如阴影）
+    cairo_surface_t* surface = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, nullptr);
+    cairo_t* cr = cairo_create(surface);
+    cairo_set_antialias(cr, antialias);
+    renderOutset(cr);
+
+    // 裁剪溢出只限制节点自身的内容，外阴影等在裁剪之前绘制
+    if (getOverflow() == Overflow::Hidden) {
+        cairo_rectangle(cr, 0, 0, width, height);
+        cairo_clip(cr);
+    }
+    render(cr);
+    cairo_destroy(cr);
+
+    // 创建新的记录而不是修改旧的，已经提交的帧显示列表仍然引用旧记录
+    m_recording = std::make_shared<SRecording>(surface);
+    return m_recording;
+}
+
+void SLayout::recordDisplayList(SDisplayList& list, cairo_antialias_t antialias) {
+    m_renderStats = RenderStats();
+    g_paintFrame++;
+    recordDisplayListImpl(list, 0.0, 0.0, antialias, nullptr, m_renderStats);
+}
+
+void SLayout::recordDisplayList(SDisplayList& list, cairo_antialias_t antialias, const Rect& clip) {
+    m_renderStats = RenderStats();
+    g_paintFrame++;
+    recordDisplayListImpl(list, 0.0, 0.0, antialias, &clip, m_renderStats);
+}
+
+void SLayout::recordDisplayListImpl(SDisplayList& list, double deviceX, double deviceY, cairo_antialias_t antialias,
+                                    const Rect* clip, RenderStats& stats) {
+    float left = getLeft();
+    float top = getTop();
+    float width = getLayoutWidth();
+    float height = getLayoutHeight();
+    double nodeX = deviceX + left;
+    double nodeY = deviceY + top;
+
+    // 子树范围在裁剪矩形之外时不记录整棵子树
+    if (clip) {
+        const Rect& subtree = getSubtreeBounds();
+        if (!intersectsClip(*clip, nodeX + subtree.x, nodeY + subtree.y, subtree.width, subtree.height)) {
+            stats.culledNodes += m_subtreeCount;
+            return;
+        }
+    }
+
+    // 层在设备坐标系中贴图
+    if (shouldUseLayer()) {
+        double x, y;
+        cairo_surface_t* surface = acquireLayer(nodeX, nodeY, antialias, x, y);
+        if (surface) {
+            list.drawSurface(surface, x, y);
+            cairo_surface_destroy(surface);
+            stats.paintedNodes++;
+            return;
+        }
+    }
+
+    // 子树完整记录时统计耗时：节点记录失效时包括重新执行render()的开销
+    bool measure = m_layerMode == LayerMode::Auto && !m_children.empty();
+    if (measure && clip) {
+        const Rect& subtree = getSubtreeBounds();
+        measure = containedInClip(*clip, nodeX + subtree.x, nodeY + subtree.y, subtree.width, subtree.height);
+    }
+    auto start = measure ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+
+    list.save();
+    list.translate(left, top);
+
+    Rect paint = getPaintBounds();
+    if (!clip || intersectsClip(*clip, nodeX + paint.x, nodeY + paint.y, paint.width, paint.height)) {
+        list.drawRecording(getRecording(antialias));
+        stats.paintedNodes++;
+    } else {
+        stats.culledNodes++;
+    }
+
+    // 裁剪溢出时子节点的裁剪矩形缩小到节点边界
+    Rect childClip;
+    const Rect* childClipPtr = clip;
+    if (getOverflow() == Overflow::Hidden) {
+        list.clipRect(0, 0, width, height);
+        if (clip) {
+            childClip = clip->intersect(Rect(nodeX, nodeY, width, height));
+            childClipPtr = &childClip;
+        }
+    }
+
+    for (const auto& child : m_children) {
+        if (child->getDisplay() != Display::None) {
+            child->recordDisplayListImpl(list, nodeX, nodeY, antialias, childClipPtr, stats);
+        }
+    }
+    list.restore();
+
+    if (measure) {
+        m_paintCostUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+const Rect& SLayout::getSubtreeBounds() {
+    if (m_subtreeBoundsVersion == g_layoutVersion) {
+        return m_subtreeBounds;
+    }
+
+    Rect paint = getPaintBounds();
+    double x0 = paint.x, y0 = paint.y, x1 = paint.x + paint.width, y1 = paint.y + paint.height;
+    size_t count = 1;
+
+    // 裁剪溢出时子孙节点不会超出自身边界（节点自身的绘制范围已经包含边界），但仍然统计节点数
+    bool hidden = getOverflow() == Overflow::Hidden;
+    for (const auto& child : m_children) {
+        if (child->getDisplay() == Display::None) {
+            continue;
+        }
+        const Rect& childBounds = child->getSubtreeBounds();
+        count += child->m_subtreeCount;
+        if (hidden) {
+            continue;
+        }
+        double cx = child->getLeft() + childBounds.x;
+        double cy = child->getTop() + childBounds.y;
+        x0 = std::min(x0, cx);
+        y0 = std::min(y0, cy);
+        x1 = std::max(x1, cx + childBounds.width);
+        y1 = std::max(y1, cy + childBounds.height);
+    }
+
+    m_subtreeBounds = Rect(x0, y0, x1 - x0, y1 - y0);
+    m_subtreeCount = count;
+    m_subtreeBoundsVersion = g_layoutVersion;
+    return m_subtreeBounds;
+}
+
+void SLayout::collectDamage(cairo_region_t* damage, bool force) {
+    if (!damage) return;
+    collectDamageImpl(damage, 0.0f, 0.0f, force, false);
+}
+
+void SLayout::collectDamageImpl(cairo_region_t* damage, float parentX, float parentY, bool force, bool hidden) {
+    if (!force && !m_subtreePaintDirty) {
+        return;
+    }
+
+    float x = parentX + getLeft();
+    float y = parentY + getTop();
+    bool visible = !hidden && getDisplay() != Display::None;
+
+    Rect bounds;
+    if (visible) {
+        Rect paint = getPaintBounds();
+        bounds = Rect(x + paint.x, y + paint.y, paint.width, paint.height);
+    }
+    bool hasBounds = visible && !bounds.isEmpty();
+
+    bool moved = hasBounds != m_hasPaintedBounds ||
+                 (hasBounds && (bounds.x != m_paintedBounds.x || bounds.y != m_paintedBounds.y ||
+                                bounds.width != m_paintedBounds.width || bounds.height != m_paintedBounds.height));
+
+    // 旧位置需要擦除，新位置需要绘制
+    if (m_paintDirty || moved) {
+        if (m_hasPaintedBounds) {
+            addDamageRect(damage, m_paintedBounds);
+        }
+        if (hasBounds) {
+            addDamageRect(damage, bounds);
+        }
+    }
+
+    for (const auto& rect : m_removedDamage) {
+        addDamageRect(damage, rect);
+    }
+    m_removedDamage.clear();
+
+    m_paintedBounds = bounds;
+    m_hasPaintedBounds = hasBounds;
+
+    for (auto& child : m_children) {
+        child->collectDamageImpl(damage, x, y, force, !visible);
+    }
+}
+
+void SLayout::takePaintedBounds(std::vector<Rect>& out) {
+    if (m_hasPaintedBounds) {
+        out.push_back(m_paintedBounds);
+    }
+    m_hasPaintedBounds = false;
+    m_paintedBounds = Rect();
+
+    for (const auto& rect : m_removedDamage) {
+        out.push_back(rect);
+    }
+    m_removedDamage.clear();
+
+    for (auto& child : m_children) {
+        child->takePaintedBounds(out);
+    }
+}
+
+Rect SLayout::getPaintBounds() const {
+    return Rect(0, 0, getLayoutWidth(), getLayoutHeight());
+}
+
+void SLayout::invalidatePaintBounds() {
+    g_layoutVersion++;
+    markPaintDirty();
+}
+
+void SLayout::notifyDetached() {
+    onDetached();
+    for (const auto& child : m_children) {
+        child->notifyDetached();
+    }
 }
 
 void SLayout::printLayoutTree(int depth) const {
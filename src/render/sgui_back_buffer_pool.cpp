@@ -0,0 +1,174 @@
+/**
+ * 后缓冲存储池实现
+ */
+
+#include "internal/sgui_back_buffer_pool.h"
+#include <cairo/cairo.h>
+#include <algorithm>
+#include <cmath>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace sgui {
+
+SBackBufferPool& SBackBufferPool::instance() {
+    static SBackBufferPool* pool = new SBackBufferPool();
+    return *pool;
+}
+
+SBackBufferPool::~SBackBufferPool() {
+    trim();
+}
+
+SBackBuffer SBackBufferPool::acquire(int width, int height, bool* reused) {
+    if (reused) {
+        *reused = false;
+    }
+    if (width <= 0 || height <= 0) {
+        return SBackBuffer();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // 选择能容纳请求的最小缓存，避免小窗口占用大存储
+        auto best = m_cached.end();
+        for (auto it = m_cached.begin(); it != m_cached.end(); ++it) {
+            if (it->width >= width && it->height >= height && (best == m_cached.end() || it->size < best->size)) {
+                best = it;
+            }
+        }
+        if (best != m_cached.end()) {
+            SBackBuffer buffer = *best;
+            m_cached.erase(best);
+            m_stats.cachedBytes -= buffer.size;
+            m_stats.reuses++;
+            if (reused) {
+                *reused = true;
+            }
+            return buffer;
+        }
+    }
+
+    SBackBuffer buffer = allocate(width, height);
+    if (buffer) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.allocations++;
+        if (buffer.mapped) {
+            m_stats.hugePageBuffers++;
+        }
+    }
+    return buffer;
+}
+
+void SBackBufferPool::release(SBackBuffer buffer) {
+    if (!buffer) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cached.push_back(buffer);
+    m_stats.cachedBytes += buffer.size;
+    evictLocked();
+}
+
+void SBackBufferPool::trim() {
+    std::vector<SBackBuffer> cached;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        cached.swap(m_cached);
+        m_stats.cachedBytes = 0;
+    }
+    for (auto& buffer : cached) {
+        freeBuffer(buffer);
+    }
+}
+
+void SBackBufferPool::setCacheBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cacheBudget = bytes;
+    evictLocked();
+}
+
+BackBufferPoolStats SBackBufferPool::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void SBackBufferPool::growSize(int currentWidth, int currentHeight, int requestWidth, int requestHeight,
+                               int& width, int& height) {
+    width = currentWidth;
+    height = currentHeight;
+    if (requestWidth > currentWidth) {
+        width = std::max(requestWidth, static_cast<int>(std::ceil(currentWidth * kGrowthFactor)));
+    }
+    if (requestHeight > currentHeight) {
+        height = std::max(requestHeight, static_cast<int>(std::ceil(currentHeight * kGrowthFactor)));
+    }
+}
+
+SBackBuffer SBackBufferPool::allocate(int width, int height) {
+    SBackBuffer buffer;
+    int stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width);
+    if (stride <= 0) {
+        return buffer;
+    }
+    size_t size = static_cast<size_t>(stride) * height;
+
+#ifdef __linux__
+    if (size >= kHugePageThreshold) {
+        // 按大页对齐长度，并提示内核使用透明大页
+        size_t mappedSize = (size + kHugePageThreshold - 1) / kHugePageThreshold * kHugePageThreshold;
+        void* data = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data != MAP_FAILED) {
+#ifdef MADV_HUGEPAGE
+            madvise(data, mappedSize, MADV_HUGEPAGE);
+#endif
+            buffer.data = static_cast<unsigned char*>(data);
+            buffer.size = mappedSize;
+            buffer.mapped = true;
+        }
+    }
+#endif
+
+    if (!buffer.data) {
+        buffer.data = new (std::nothrow) unsigned char[size];
+        buffer.size = size;
+        buffer.mapped = false;
+        if (!buffer.data) {
+            return SBackBuffer();
+        }
+    }
+
+    buffer.width = width;
+    buffer.height = height;
+    buffer.stride = stride;
+    return buffer;
+}
+
+void SBackBufferPool::freeBuffer(SBackBuffer& buffer) {
+#ifdef __linux__
+    if (buffer.mapped) {
+        munmap(buffer.data, buffer.size);
+        buffer = SBackBuffer();
+        return;
+    }
+#endif
+    delete[] buffer.data;
+    buffer = SBackBuffer();
+}
+
+void SBackBufferPool::evictLocked() {
+    // 最早归还的存储最不可能被再次用到
+    while (m_stats.cachedBytes > m_cacheBudget && !m_cached.empty()) {
+        SBackBuffer buffer = m_cached.front();
+        m_cached.erase(m_cached.begin());
+        m_stats.cachedBytes -= buffer.size;
+        freeBuffer(buffer);
+    }
+}
+
+} // namespace sgui
@@ -0,0 +1,276 @@
+/**
+ * A8图像模糊实现
+ */
+
+#include "internal/sgui_blur.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SGUI_BLUR_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// AVX2版本通过函数级target属性编译，不需要整个库使用-mavx2
+#if defined(SGUI_BLUR_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define SGUI_BLUR_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace sgui {
+
+namespace {
+
+// 三次盒式模糊近似标准差为sigma的高斯模糊时各次的半径
+void boxRadiiForGauss(double sigma, int radii[3]) {
+    const int passes = 3;
+    double ideal = std::sqrt(12.0 * sigma * sigma / passes + 1.0);
+    int lower = static_cast<int>(std::floor(ideal));
+    if (lower % 2 == 0) {
+        lower--;
+    }
+    int upper = lower + 2;
+    double lowerCount = (12.0 * sigma * sigma - passes * lower * lower - 4.0 * passes * lower - 3.0 * passes) /
+                        (-4.0 * lower - 4.0);
+    int count = static_cast<int>(std::lround(lowerCount));
+    for (int i = 0; i < passes; ++i) {
+        int size = i < count ? lower : upper;
+        radii[i] = std::max(0, (size - 1) / 2);
+    }
+}
+
+// 输出像素 = 窗口和 * (1 / 窗口大小)，四舍五入；所有实现使用同样的单精度运算
+inline uint8_t scaleSum(int32_t sum, float scale) {
+    return static_cast<uint8_t>(static_cast<int32_t>(static_cast<float>(sum) * scale + 0.5f));
+}
+
+// 逐列滑动求和的标量实现，处理[x0, x1)列
+void boxBlurColumnsScalar(const uint8_t* src, uint8_t* dst, int x0, int x1, int height, int stride, int radius,
+                          int32_t* sums) {
+    float scale = 1.0f / static_cast<float>(2 * radius + 1);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* add = src + static_cast<size_t>(std::min(y + radius + 1, height - 1)) * stride;
+        const uint8_t* sub = src + static_cast<size_t>(std::max(y - radius, 0)) * stride;
+        uint8_t* out = dst + static_cast<size_t>(y) * stride;
+        for (int x = x0; x < x1; ++x) {
+            out[x] = scaleSum(sums[x], scale);
+            sums[x] += static_cast<int32_t>(add[x]) - static_cast<int32_t>(sub[x]);
+        }
+    }
+}
+
+#ifdef SGUI_BLUR_SSE2
+// 每次处理16列，返回处理到的列
+int boxBlurColumnsSSE2(const uint8_t* src, uint8_t* dst, int width, int height, int stride, int radius,
+                       int32_t* sums) {
+    const int vectorWidth = width & ~15;
+    const __m128 scale = _mm_set1_ps(1.0f / static_cast<float>(2 * radius + 1));
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* add = src + static_cast<size_t>(std::min(y + radius + 1, height - 1)) * stride;
+        const uint8_t* sub = src + static_cast<size_t>(std::max(y - radius, 0)) * stride;
+        uint8_t* out = dst + static_cast<size_t>(y) * stride;
+        for (int x = 0; x < vectorWidth; x += 16) {
+            __m128i s0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sums + x));
+            __m128i s1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sums + x + 4));
+            __m128i s2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sums + x + 8));
+            __m128i s3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sums + x + 12));
+
+            __m128i o0 = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(s0), scale), half));
+            __m128i o1 = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(s1), scale), half));
+            __m128i o2 = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(s2), scale), half));
+            __m128i o3 = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(s3), scale), half));
+            __m128i packed = _mm_packus_epi16(_mm_packs_epi32(o0, o1), _mm_packs_epi32(o2, o3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), packed);
+
+            // 窗口下移一行：加上进入窗口的行，减去离开窗口的行
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(add + x));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sub + x));
+            __m128i aLo = _mm_unpacklo_epi8(a, zero);
+            __m128i aHi = _mm_unpackhi_epi8(a, zero);
+            __m128i bLo = _mm_unpacklo_epi8(b, zero);
+            __m128i bHi = _mm_unpackhi_epi8(b, zero);
+            __m128i d0 = _mm_sub_epi16(aLo, bLo); // 差值在[-255, 255]，16位有符号足够
+            __m128i d1 = _mm_sub_epi16(aHi, bHi);
+            __m128i sign0 = _mm_srai_epi16(d0, 15);
+            __m128i sign1 = _mm_srai_epi16(d1, 15);
+            s0 = _mm_add_epi32(s0, _mm_unpacklo_epi16(d0, sign0));
+            s1 = _mm_add_epi32(s1, _mm_unpackhi_epi16(d0, sign0));
+            s2 = _mm_add_epi32(s2, _mm_unpacklo_epi16(d1, sign1));
+            s3 = _mm_add_epi32(s3, _mm_unpackhi_epi16(d1, sign1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + x), s0);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + x + 4), s1);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + x + 8), s2);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + x + 12), s3);
+        }
+    }
+    return vectorWidth;
+}
+#endif
+
+#ifdef SGUI_BLUR_AVX2
+// 每次处理32列，返回处理到的列
+__attribute__((target("avx2"))) int boxBlurColumnsAVX2(const uint8_t* src, uint8_t* dst, int width, int height,
+                                                        int stride, int radius, int32_t* sums) {
+    const int vectorWidth = width & ~31;
+    const __m256 scale = _mm256_set1_ps(1.0f / static_cast<float>(2 * radius + 1));
+    const __m256 half = _mm256_set1_ps(0.5f);
+
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* add = src + static_cast<size_t>(std::min(y + radius + 1, height - 1)) * stride;
+        const uint8_t* sub = src + static_cast<size_t>(std::max(y - radius, 0)) * stride;
+        uint8_t* out = dst + static_cast<size_t>(y) * stride;
+        for (int x = 0; x < vectorWidth; x += 32) {
+            __m256i s[4];
+            __m256i o[4];
+            for (int i = 0; i < 4; ++i) {
+                s[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sums + x + i * 8));
+                o[i] = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(s[i]), scale), half));
+            }
+            // AVX2的pack按128位通道交错，最后按64位重新排列
+            __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(o[0], o[1]), _mm256_packs_epi32(o[2], o[3]));
+            packed = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), packed);
+
+            for (int i = 0; i < 4; ++i) {
+                __m256i a = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(add + x + i * 8)));
+                __m256i b = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(sub + x + i * 8)));
+                s[i] = _mm256_add_epi32(s[i], _mm256_sub_epi32(a, b));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(sums + x + i * 8), s[i]);
+            }
+        }
+    }
+    return vectorWidth;
+}
+#endif
+
+// 对每一列做半径为radius的盒式模糊，src和dst不能重叠
+void boxBlurColumns(const uint8_t* src, uint8_t* dst, int width, int height, int stride, int radius,
+                    BlurKernel kernel, std::vector<int32_t>& sums) {
+    // 初始窗口[-radius, radius]，图像以外的行取边缘行
+    sums.assign(static_cast<size_t>(width), 0);
+    for (int i = -radius; i <= radius; ++i) {
+        const uint8_t* row = src + static_cast<size_t>(std::min(std::max(i, 0), height - 1)) * stride;
+        for (int x = 0; x < width; ++x) {
+            sums[x] += row[x];
+        }
+    }
+
+    int done = 0;
+#ifdef SGUI_BLUR_AVX2
+    if (kernel == BlurKernel::AVX2) {
+        done = boxBlurColumnsAVX2(src, dst, width, height, stride, radius, sums.data());
+    }
+#endif
+#ifdef SGUI_BLUR_SSE2
+    if (kernel != BlurKernel::Scalar && done == 0) {
+        done = boxBlurColumnsSSE2(src, dst, width, height, stride, radius, sums.data());
+    }
+#endif
+    (void)kernel;
+    if (done < width) {
+        boxBlurColumnsScalar(src, dst, done, width, height, stride, radius, sums.data());
+    }
+}
+
+// 转置A8图像：src为width x height，dst为height x width
+void transposeA8(const uint8_t* src, int width, int height, int srcStride, uint8_t* dst, int dstStride) {
+    const int block = 16;
+    for (int by = 0; by < height; by += block) {
+        for (int bx = 0; bx < width; bx += block) {
+            int yEnd = std::min(by + block, height);
+            int xEnd = std::min(bx + block, width);
+            for (int y = by; y < yEnd; ++y) {
+                const uint8_t* row = src + static_cast<size_t>(y) * srcStride;
+                for (int x = bx; x < xEnd; ++x) {
+                    dst[static_cast<size_t>(x) * dstStride + y] = row[x];
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+BlurKernel detectBlurKernel() {
+#if defined(SGUI_BLUR_AVX2)
+    static const BlurKernel kernel = __builtin_cpu_supports("avx2") ? BlurKernel::AVX2 : BlurKernel::SSE2;
+    return kernel;
+#elif defined(SGUI_BLUR_SSE2)
+    return BlurKernel::SSE2;
+#else
+    return BlurKernel::Scalar;
+#endif
+}
+
+const char* blurKernelName(BlurKernel kernel) {
+    switch (kernel) {
+    case BlurKernel::AVX2:
+        return "AVX2";
+    case BlurKernel::SSE2:
+        return "SSE2";
+    default:
+        return "Scalar";
+    }
+}
+
+int gaussianBlurExtent(double sigma) {
+    if (sigma <= 0.0) {
+        return 0;
+    }
+    int radii[3];
+    boxRadiiForGauss(sigma, radii);
+    return radii[0] + radii[1] + radii[2];
+}
+
+void gaussianBlurA8(unsigned char* data, int width, int height, int stride, double sigma, BlurKernel kernel) {
+    if (!data || width <= 0 || height <= 0 || sigma <= 0.0) {
+        return;
+    }
+
+    // 不支持的实现退回到可用的实现
+    BlurKernel best = detectBlurKernel();
+    if (static_cast<int>(kernel) > static_cast<int>(best)) {
+        kernel = best;
+    }
+
+    int radii[3];
+    boxRadiiForGauss(sigma, radii);
+
+    // 盒式模糊可以交换顺序：先在转置图像上做三次垂直模糊（即水平模糊），转置回来再做三次垂直模糊，
+    // 两个方向都使用同一个按列向量化的实现
+    size_t bufferSize = std::max(static_cast<size_t>(width) * height, static_cast<size_t>(stride) * height);
+    std::vector<uint8_t> transposed(bufferSize);
+    std::vector<uint8_t> scratch(bufferSize);
+    std::vector<int32_t> sums;
+
+    transposeA8(data, width, height, stride, transposed.data(), height);
+    for (int radius : radii) {
+        if (radius > 0) {
+            boxBlurColumns(transposed.data(), scratch.data(), height, width, height, radius, kernel, sums);
+            transposed.swap(scratch);
+        }
+    }
+    transposeA8(transposed.data(), height, width, height, data, stride);
+
+    for (int radius : radii) {
+        if (radius > 0) {
+            boxBlurColumns(data, scratch.data(), width, height, stride, radius, kernel, sums);
+            for (int y = 0; y < height; ++y) {
+                std::memcpy(data + static_cast<size_t>(y) * stride, scratch.data() + static_cast<size_t>(y) * stride,
+                            static_cast<size_t>(width));
+            }
+        }
+    }
+}
+
+void gaussianBlurA8(unsigned char* data, int width, int height, int stride, double sigma) {
+    gaussianBlurA8(data, width, height, stride, sigma, detectBlurKernel());
+}
+
+} // namespace sgui
@@ -3,10 +3,22 @@
  */
 
 #include "sgui_cairo_renderer.h"
+#include "sgui_display_list.h"
+#include "sgui_thread_pool.h"
+#include "internal/sgui_back_buffer_pool.h"
+#include "internal/sgui_present_rects.h"
+#include "internal/sgui_xshm_presenter.h"
 #include <iostream>
 #include <cstring>
 #include <cmath>
 #include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -19,16 +31,49 @@
 
 namespace sgui {
 
-SCairoRenderer::SCairoRenderer(void* windowId, int width, int height)
+namespace {
+
+// 区域矩形数超过该值时直接呈现包围盒
+constexpr int kMaxRegionRects = 64;
+
+int64_t rectArea(const cairo_rectangle_int_t& rect) {
+    return static_cast<int64_t>(rect.width) * rect.height;
+}
+
+} // namespace
+
+SCairoRenderer::SCairoRenderer(void* windowId, int width, int height, void* nativeDisplay)
     : m_windowId(windowId), m_width(width), m_height(height)
     , m_frontSurface(nullptr), m_frontCairo(nullptr)
-    , m_backSurface(nullptr), m_backCairo(nullptr) {
+    , m_backSurface(nullptr), m_backCairo(nullptr)
+    , m_backStorage(std::make_unique<SBackBuffer>())
+    , m_pendingClear(cairo_region_create()) {
+
+#ifdef __linux__
+    if (m_windowId) {
+        // 优先共享窗口系统的X连接，只有调用者没有提供时才自己打开一个
+        m_display = nativeDisplay;
+        if (!m_display) {
+            m_display = XOpenDisplay(nullptr);
+            m_ownsDisplay = m_display != nullptr;
+        }
+    }
+#else
+    (void)nativeDisplay;
+#endif
     
     initCairoSurface();
 }
 
 SCairoRenderer::~SCairoRenderer() {
     cleanupCairoSurface();
+    cairo_region_destroy(m_pendingClear);
+
+#ifdef __linux__
+    if (m_ownsDisplay) {
+        XCloseDisplay(static_cast<::Display*>(m_display));
+    }
+#endif
 }
 
 void SCairoRenderer::resize(int width, int height) {
@@ -38,44 +83,374 @@ void SCairoRenderer::resize(int width, int height) {
     
     m_width = width;
     m_height = height;
-    
-    // 重新初始化Cairo表面
-    cleanupCairoSurface();
-    initCairoSurface();
+    m_resizeStats.resizes++;
+
+    // 初始化失败过的渲染器整体重建；非X11平台的前缓冲不支持调整尺寸，也整体重建
+    bool rebuild = !m_backSurface || (!isHeadless() && !m_frontSurface);
+#ifndef __linux__
+    rebuild = rebuild || m_frontSurface != nullptr;
+#endif
+    if (rebuild) {
+        cleanupCairoSurface();
+        initCairoSurface();
+        return;
+    }
+
+    // 后缓冲表面只是存储的视图，销毁视图不会释放像素
+    destroyBackView();
+
+#ifdef __linux__
+    // xlib前缓冲只需要更新尺寸，不需要重新创建
+    if (m_frontSurface) {
+        cairo_xlib_surface_set_size(m_frontSurface, width, height);
+        cairo_destroy(m_frontCairo);
+        m_frontCairo = cairo_create(m_frontSurface);
+    }
+#endif
+
+    // 存储只在需要变大时重新分配，并按增长系数过度分配，连续放大时不会每次都重新分配
+    if (width > m_bufferWidth || height > m_bufferHeight) {
+        int newWidth, newHeight;
+        SBackBufferPool::growSize(m_bufferWidth, m_bufferHeight, width, height, newWidth, newHeight);
+        if (!allocateBackStorage(newWidth, newHeight)) {
+            return;
+        }
+    }
+    createBackView();
 }
 
 void SCairoRenderer::begin() {
     if (!m_backCairo) {
         return;
     }
+
+#ifdef SGUI_HAVE_XSHM
+    // X服务器可能还在读取上一帧的共享内存，修改前必须等待呈现完成
+    if (m_shmPresenter) {
+        m_shmPresenter->waitIdle();
+    }
+#endif
     
     // 重置变换矩阵
     cairo_identity_matrix(m_backCairo);
     
-    // 清除后缓冲为白色背景
-    cairo_save(m_backCairo);
-    cairo_set_source_rgba(m_backCairo, 1.0, 1.0, 1.0, 1.0);
-    cairo_fill(m_backCairo);
-    cairo_restore(m_backCairo);
+    // 后缓冲保留上一帧的内容，只把内容未定义的区域清除为白色背景
+    cairo_rectangle_int_t view = {0, 0, m_width, m_height};
+    cairo_region_intersect_rectangle(m_pendingClear, &view);
+    if (!cairo_region_is_empty(m_pendingClear)) {
+        cairo_save(m_backCairo);
+        int count = cairo_region_num_rectangles(m_pendingClear);
+        for (int i = 0; i < count; ++i) {
+            cairo_rectangle_int_t rect;
+            cairo_region_get_rectangle(m_pendingClear, i, &rect);
+            cairo_rectangle(m_backCairo, rect.x, rect.y, rect.width, rect.height);
+        }
+        cairo_clip(m_backCairo);
+        cairo_set_source_rgba(m_backCairo, 1.0, 1.0, 1.0, 1.0);
+        cairo_paint(m_backCairo);
+        cairo_restore(m_backCairo);
+
+        cairo_region_destroy(m_pendingClear);
+        m_pendingClear = cairo_region_create();
+    }
 }
 
 void SCairoRenderer::end() {
-    if (!m_backSurface || !m_frontCairo) {
+    end(nullptr);
+}
+
+
+void SCairoRenderer::end(int x, int y, int width, int height) {
+    if (width <= 0 || height <= 0) {
         return;
     }
     
-    // 将后缓冲内容绘制到前缓冲
+    // 只复制指定矩形
+    presentRects({cairo_rectangle_int_t{x, y, width, height}});
+}
+
+void SCairoRenderer::end(const cairo_region_t* damage) {
+    if (!m_backSurface || !m_frontCairo) {
+        return;
+    }
+
+    cairo_rectangle_int_t bounds = {0, 0, m_width, m_height};
+    if (!damage) {
+        presentRects({bounds});
+        return;
+    }
+
+    std::vector<cairo_rectangle_int_t> rects;
+    int count = cairo_region_num_rectangles(damage);
+    if (count > kMaxRegionRects) {
+        // 矩形太多时合并的计算量不划算，直接呈现包围盒
+        cairo_rectangle_int_t extents;
+        cairo_region_get_extents(damage, &extents);
+        rects.push_back(extents);
+    } else {
+        rects.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            cairo_rectangle_int_t rect;
+            cairo_region_get_rectangle(damage, i, &rect);
+            rects.push_back(rect);
+        }
+        mergePresentRects(rects, kMaxPresentRects);
+    }
+
+    // 限制在表面范围内
+    for (auto& rect : rects) {
+        int x0 = std::max(rect.x, bounds.x);
+        int y0 = std::max(rect.y, bounds.y);
+        int x1 = std::min(rect.x + rect.width, bounds.width);
+        int y1 = std::min(rect.y + rect.height, bounds.height);
+        rect = {x0, y0, std::max(0, x1 - x0), std::max(0, y1 - y0)};
+    }
+    rects.erase(std::remove_if(rects.begin(), rects.end(),
+                               [](const cairo_rectangle_int_t& r) { return r.width <= 0 || r.height <= 0; }),
+                rects.end());
+    if (rects.empty()) {
+        return;
+    }
+    presentRects(rects);
+}
+
+void SCairoRenderer::presentRects(const std::vector<cairo_rectangle_int_t>& rects) {
+    if (!m_backSurface || !m_frontCairo) {
+        return;
+    }
+
+    uint64_t bytes = 0;
+    for (const auto& rect : rects) {
+        bytes += static_cast<uint64_t>(rectArea(rect)) * 4;
+    }
+
+#ifdef SGUI_HAVE_XSHM
+    if (m_shmPresenter) {
+        // 后缓冲就在共享内存中，服务器直接读取，不需要经过X socket传输像素
+        cairo_surface_flush(m_backSurface);
+        m_shmPresenter->present(rects);
+        m_presentStats.lastFrameBytes = bytes;
+        m_presentStats.lastFrameRects = rects.size();
+        m_presentStats.totalBytes += bytes;
+        m_presentStats.frames++;
+        return;
+    }
+#endif
+
+    // 将后缓冲中的矩形绘制到前缓冲
     cairo_save(m_frontCairo);
+    for (const auto& rect : rects) {
+        cairo_rectangle(m_frontCairo, rect.x, rect.y, rect.width, rect.height);
+    }
+    cairo_clip(m_frontCairo);
     cairo_set_source_surface(m_frontCairo, m_backSurface, 0, 0);
     cairo_paint(m_frontCairo);
     cairo_restore(m_frontCairo);
     
     // 刷新前缓冲到窗口
     cairo_surface_flush(m_frontSurface);
+
+    m_presentStats.lastFrameBytes = bytes;
+    m_presentStats.lastFrameRects = rects.size();
+    m_presentStats.totalBytes += bytes;
+    m_presentStats.frames++;
 }
 
+void SCairoRenderer::rasterize(const SDisplayList& list, const cairo_region_t* damage) {
+    if (!m_backSurface) {
+        return;
+    }
+
+    // 需要重绘的区域限制在表面范围内
+    cairo_rectangle_int_t bounds = {0, 0, m_width, m_height};
+    cairo_region_t* region = damage ? cairo_region_copy(damage) : cairo_region_create_rectangle(&bounds);
+    cairo_region_intersect_rectangle(region, &bounds);
+
+    // 收集与区域相交的图块
+    std::vector<cairo_rectangle_int_t> tiles;
+    for (int ty = 0; ty < m_height; ty += m_tileSize) {
+        for (int tx = 0; tx < m_width; tx += m_tileSize) {
+            cairo_rectangle_int_t tile = {tx, ty, std::min(m_tileSize, m_width - tx), std::min(m_tileSize, m_height - ty)};
+            if (cairo_region_contains_rectangle(region, &tile) != CAIRO_REGION_OVERLAP_OUT) {
+                tiles.push_back(tile);
+            }
+        }
+    }
+
+    // 图块直接写后缓冲的存储，前后需要与后缓冲表面同步
+    cairo_surface_flush(m_backSurface);
+    unsigned char* data = cairo_image_surface_get_data(m_backSurface);
+    int stride = cairo_image_surface_get_stride(m_backSurface);
+    cairo_antialias_t antialias = cairo_get_antialias(m_backCairo);
+
+    auto renderTile = [&](const cairo_rectangle_int_t& tile) {
+        // 图块表面是后缓冲存储的视图，设备偏移使显示列表仍然使用整个窗口的坐标
+        cairo_surface_t* surface = cairo_image_surface_create_for_data(
+            data + static_cast<size_t>(tile.y) * stride + static_cast<size_t>(tile.x) * 4,
+            CAIRO_FORMAT_ARGB32, tile.width, tile.height, stride);
+        cairo_surface_set_device_offset(surface, -tile.x, -tile.y);
+        cairo_t* cr = cairo_create(surface);
+        cairo_set_antialias(cr, antialias);
+
+        // 裁剪到图块内的损坏区域
+        cairo_region_t* clip = cairo_region_copy(region);
+        cairo_region_intersect_rectangle(clip, &tile);
+        int count = cairo_region_num_rectangles(clip);
+        for (int i = 0; i < count; ++i) {
+            cairo_rectangle_int_t rect;
+            cairo_region_get_rectangle(clip, i, &rect);
+            cairo_rectangle(cr, rect.x, rect.y, rect.width, rect.height);
+        }
+        cairo_clip(cr);
+        cairo_region_destroy(clip);
+
+        list.replay(cr);
+
+        cairo_destroy(cr);
+        cairo_surface_finish(surface);
+        cairo_surface_destroy(surface);
+    };
+
+    // 工作线程中调用时不能等待同一个线程池，退化为串行
+    SThreadPool* pool = nullptr;
+    size_t threads = static_cast<size_t>(std::max(0, m_rasterThreads.load()));
+    if (threads != 1 && tiles.size() > 1) {
+        pool = &SThreadPool::instance();
+        if (pool->isWorkerThread()) {
+            pool = nullptr;
+            threads = 1;
+        } else if (threads == 0) {
+            threads = pool->getThreadCount() + 1;
+        }
+    }
+    threads = std::max<size_t>(1, std::min(threads, tiles.size()));
+
+    if (threads == 1 || !pool) {
+        for (const auto& tile : tiles) {
+            renderTile(tile);
+        }
+        threads = 1;
+    } else {
+        // 图块按顺序动态领取：调用线程和提交的辅助任务都从同一个计数器取下一个图块。
+        // 线程池被耗时任务（例如图片解码）占满时辅助任务可能迟迟不能开始，
+        // 调用线程不等待它们，而是自己处理剩下的图块，只等待已经开始的辅助任务结束；
+        // 调用线程返回后才开始的辅助任务直接退出，不会访问已经失效的栈上数据
+        struct RasterJob {
+            std::atomic<size_t> next{0};
+            std::mutex mutex;
+            std::condition_variable idle;
+            size_t active = 0;  // 正在回放的辅助任务数
+            size_t helpers = 0; // 参与过回放的辅助任务数
+            bool closed = false;
+        };
+        auto job = std::make_shared<RasterJob>();
+        auto renderTiles = [&]() {
+            size_t i;
+            while ((i = job->next.fetch_add(1, std::memory_order_relaxed)) < tiles.size()) {
+                renderTile(tiles[i]);
+            }
+        };
+
+        for (size_t helper = 1; helper < threads; ++helper) {
+            pool->submit([job, &renderTiles]() {
+                {
+                    std::lock_guard<std::mutex> lock(job->mutex);
+                    if (job->closed) {
+                        return;
+                    }
+                    job->active++;
+                    job->helpers++;
+                }
+                renderTiles();
+                {
+                    std::lock_guard<std::mutex> lock(job->mutex);
+                    job->active--;
+                }
+                job->idle.notify_all();
+            });
+        }
+        renderTiles();
+
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->closed = true;
+        job->idle.wait(lock, [&job]() { return job->active == 0; });
+        threads = job->helpers + 1;
+    }
+
+    cairo_surface_mark_dirty(m_backSurface);
+    cairo_region_destroy(region);
+
+    m_rasterStats.tiles = tiles.size();
+    m_rasterStats.threads = threads;
+}
+
+void SCairoRenderer::setTileSize(int size) {
+    m_tileSize = std::max(16, size);
+}
+
+void SCairoRenderer::setRasterThreads(int threads) {
+    m_rasterThreads = std::max(0, threads);
+}
+
+bool SCairoRenderer::writeToPng(const std::string& path) const {
+    if (!m_backSurface) {
+        return false;
+    }
+    cairo_surface_flush(m_backSurface);
+    return cairo_surface_write_to_png(m_backSurface, path.c_str()) == CAIRO_STATUS_SUCCESS;
+}
+
+bool SCairoRenderer::writeToPpm(const std::string& path) const {
+    if (!m_backSurface) {
+        return false;
+    }
+    cairo_surface_flush(m_backSurface);
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    int width = cairo_image_surface_get_width(m_backSurface);
+    int height = cairo_image_surface_get_height(m_backSurface);
+    int stride = cairo_image_surface_get_stride(m_backSurface);
+    const unsigned char* data = cairo_image_surface_get_data(m_backSurface);
+
+    std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::vector<unsigned char> row(static_cast<size_t>(width) * 3);
+    for (int y = 0; y < height; ++y) {
+        const uint32_t* pixels = reinterpret_cast<const uint32_t*>(data + static_cast<size_t>(y) * stride);
+        for (int x = 0; x < width; ++x) {
+            // ARGB32为本机字节序的预乘alpha格式
+            uint32_t pixel = pixels[x];
+            uint32_t a = pixel >> 24;
+            uint32_t r = (pixel >> 16) & 0xff;
+            uint32_t g = (pixel >> 8) & 0xff;
+            uint32_t b = pixel & 0xff;
+            if (a != 0 && a != 255) {
+                r = r * 255 / a;
+                g = g * 255 / a;
+                b = b * 255 / a;
+            }
+            row[x * 3 + 0] = static_cast<unsigned char>(r);
+            row[x * 3 + 1] = static_cast<unsigned char>(g);
+            row[x * 3 + 2] = static_cast<unsigned char>(b);
+        }
+        std::fwrite(row.data(), 1, row.size(), file);
+    }
+
+    bool ok = std::ferror(file) == 0;
+    std::fclose(file);
+    return ok;
+}
 
 void SCairoRenderer::initCairoSurface() {
+    if (isHeadless()) {
+        // 无窗口模式：只创建后缓冲
+        initBackBuffer();
+        return;
+    }
+
     // 1. 创建前缓冲（直接绑定到窗口）
     
 #ifdef _WIN32
@@ -86,19 +461,20 @@ void SCairoRenderer::initCairoSurface() {
     }
 #elif defined(__linux__)
     // X11平台：使用X11 Window创建直接绘制surface
-    if (m_windowId) {
-        ::Display* dpy = XOpenDisplay(nullptr);
-        if (dpy) {
-            ::Visual* visual = DefaultVisual(dpy, DefaultScreen(dpy));
-            ::Drawable drawable = static_cast<Drawable>(reinterpret_cast<uintptr_t>(m_windowId));
-            m_frontSurface = cairo_xlib_surface_create(dpy, drawable, visual, m_width, m_height);
-        }
+    ::Display* dpy = static_cast<::Display*>(m_display);
+    if (m_windowId && dpy) {
+        ::Visual* visual = DefaultVisual(dpy, DefaultScreen(dpy));
+        ::Drawable drawable = static_cast<Drawable>(reinterpret_cast<uintptr_t>(m_windowId));
+        m_frontSurface = cairo_xlib_surface_create(dpy, drawable, visual, m_width, m_height);
     }
 #endif
     
     // 检查前缓冲创建是否成功
     if (!m_frontSurface || cairo_surface_status(m_frontSurface) != CAIRO_STATUS_SUCCESS) {
         std::cerr << "Failed to create front Cairo surface" << std::endl;
+        if (m_frontSurface) {
+            cairo_surface_destroy(m_frontSurface);
+        }
         m_frontSurface = nullptr;
         return;
     }
@@ -107,6 +483,7 @@ void SCairoRenderer::initCairoSurface() {
     m_frontCairo = cairo_create(m_frontSurface);
     if (cairo_status(m_frontCairo) != CAIRO_STATUS_SUCCESS) {
         std::cerr << "Failed to create front Cairo context" << std::endl;
+        cairo_destroy(m_frontCairo);
         cairo_surface_destroy(m_frontSurface);
         m_frontSurface = nullptr;
         m_frontCairo = nullptr;
@@ -114,39 +491,124 @@ void SCairoRenderer::initCairoSurface() {
     }
     
     // 2. 创建后缓冲（内存中的图像表面）
-    m_backSurface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, m_width, m_height);
-    if (!m_backSurface || cairo_surface_status(m_backSurface) != CAIRO_STATUS_SUCCESS) {
-        std::cerr << "Failed to create back Cairo surface" << std::endl;
+    if (!initBackBuffer()) {
         cairo_destroy(m_frontCairo);
         cairo_surface_destroy(m_frontSurface);
         m_frontSurface = nullptr;
         m_frontCairo = nullptr;
-        m_backSurface = nullptr;
         return;
     }
     
+    std::cout << "Created double-buffered Cairo renderer (" << m_width << "x" << m_height << ")" << std::endl;
+}
+
+bool SCairoRenderer::initBackBuffer() {
+    return allocateBackStorage(m_width, m_height) && createBackView();
+}
+
+bool SCairoRenderer::allocateBackStorage(int width, int height) {
+    releaseBackStorage();
+
+#if defined(__linux__) && defined(SGUI_HAVE_XSHM)
+    // 优先使用共享内存呈现，不可用时回退到xlib surface
+    ::Display* dpy = static_cast<::Display*>(m_display);
+    if (m_frontSurface && dpy && !std::getenv("SGUI_DISABLE_XSHM")) {
+        ::Drawable drawable = static_cast<Drawable>(reinterpret_cast<uintptr_t>(m_windowId));
+        m_shmPresenter = SXShmPresenter::create(dpy, drawable, DefaultVisual(dpy, DefaultScreen(dpy)),
+                                                DefaultDepth(dpy, DefaultScreen(dpy)), width, height);
+        if (m_shmPresenter) {
+            m_bufferWidth = width;
+            m_bufferHeight = height;
+            m_bufferStride = m_shmPresenter->getStride();
+            m_resizeStats.backBufferAllocations++;
+            return true;
+        }
+    }
+#endif
+
+    // 从存储池获取，调整大小时释放的存储可以被复用
+    bool reused = false;
+    SBackBuffer buffer = SBackBufferPool::instance().acquire(width, height, &reused);
+    if (!buffer) {
+        std::cerr << "Failed to create back Cairo surface" << std::endl;
+        return false;
+    }
+    *m_backStorage = buffer;
+    m_bufferWidth = buffer.width;
+    m_bufferHeight = buffer.height;
+    m_bufferStride = buffer.stride;
+    if (reused) {
+        m_resizeStats.backBufferReuses++;
+    } else {
+        m_resizeStats.backBufferAllocations++;
+    }
+    return true;
+}
+
+void SCairoRenderer::releaseBackStorage() {
+    // 等待未完成的呈现并释放共享内存
+    m_shmPresenter.reset();
+    // 普通存储归还给存储池
+    SBackBufferPool::instance().release(*m_backStorage);
+    *m_backStorage = SBackBuffer();
+    m_bufferWidth = 0;
+    m_bufferHeight = 0;
+    m_bufferStride = 0;
+    m_validWidth = 0;
+    m_validHeight = 0;
+}
+
+unsigned char* SCairoRenderer::backStorageData() const {
+#ifdef SGUI_HAVE_XSHM
+    if (m_shmPresenter) {
+        // 后缓冲直接使用共享内存中的像素
+        return m_shmPresenter->getData();
+    }
+#endif
+    return m_backStorage->data;
+}
+
+bool SCairoRenderer::createBackView() {
+    // 后缓冲表面是存储左上角m_width x m_height区域的视图，行距保持为存储的行距
+    m_backSurface = cairo_image_surface_create_for_data(backStorageData(), CAIRO_FORMAT_ARGB32,
+                                                       m_width, m_height, m_bufferStride);
+    if (!m_backSurface || cairo_surface_status(m_backSurface) != CAIRO_STATUS_SUCCESS) {
+        std::cerr << "Failed to create back Cairo surface" << std::endl;
+        if (m_backSurface) {
+            cairo_surface_destroy(m_backSurface);
+        }
+        m_backSurface = nullptr;
+        return false;
+    }
+    
     // 创建后缓冲的Cairo上下文
     m_backCairo = cairo_create(m_backSurface);
     if (cairo_status(m_backCairo) != CAIRO_STATUS_SUCCESS) {
         std::cerr << "Failed to create back Cairo context" << std::endl;
-        cairo_surface_destroy(m_frontSurface);
-        cairo_surface_destroy(m_backSurface);
-        cairo_destroy(m_frontCairo);
         cairo_destroy(m_backCairo);
-        m_frontSurface = nullptr;
-        m_frontCairo = nullptr;
+        cairo_surface_destroy(m_backSurface);
         m_backSurface = nullptr;
         m_backCairo = nullptr;
-        return;
+        return false;
     }
     
-    // 设置抗锯齿
+    // 设置抗锯齿（窗口模式和无窗口模式相同，保证输出一致）
     cairo_set_antialias(m_backCairo, CAIRO_ANTIALIAS_SUBPIXEL);
-    
-    std::cout << "Created double-buffered Cairo renderer (" << m_width << "x" << m_height << ")" << std::endl;
+
+    // 存储池中的存储可能来自其他窗口，放大时新露出的部分也可能残留更早的像素；
+    // 只有上次视图范围内的内容是本渲染器绘制的，其余部分在下次begin()时清除
+    cairo_rectangle_int_t view = {0, 0, m_width, m_height};
+    cairo_rectangle_int_t valid = {0, 0, std::min(m_validWidth, m_width), std::min(m_validHeight, m_height)};
+    cairo_region_t* exposed = cairo_region_create_rectangle(&view);
+    cairo_region_subtract_rectangle(exposed, &valid);
+    cairo_region_union(m_pendingClear, exposed);
+    cairo_region_destroy(exposed);
+    m_validWidth = m_width;
+    m_validHeight = m_height;
+    return true;
 }
 
-void SCairoRenderer::cleanupCairoSurface() {
+void SCairoRenderer::destroyBackView() {
     if (m_backCairo) {
         cairo_destroy(m_backCairo);
         m_backCairo = nullptr;
@@ -156,6 +618,11 @@ void SCairoRenderer::cleanupCairoSurface() {
         cairo_surface_destroy(m_backSurface);
         m_backSurface = nullptr;
     }
+}
+
+void SCairoRenderer::cleanupCairoSurface() {
+    destroyBackView();
+    releaseBackStorage();
     
     if (m_frontCairo) {
         cairo_destroy(m_frontCairo);
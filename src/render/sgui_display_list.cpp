@@ -0,0 +1,140 @@
+/**
+ * 显示列表实现
+ */
+
+#include "sgui_display_list.h"
+
+namespace sgui {
+
+// ====================================================================
+// SRecording
+// ====================================================================
+
+SRecording::SRecording(cairo_surface_t* surface)
+    : m_surface(surface) {
+    if (m_surface) {
+        // 记录到此结束，之后不再添加绘制命令
+        cairo_surface_flush(m_surface);
+
+        // 墨迹范围只计算一次，回放时用来跳过空记录
+        double x, y, width, height;
+        cairo_recording_surface_ink_extents(m_surface, &x, &y, &width, &height);
+        m_inkBounds = Rect(x, y, width, height);
+    }
+}
+
+SRecording::~SRecording() {
+    if (m_surface) {
+        cairo_surface_destroy(m_surface);
+    }
+}
+
+void SRecording::replay(cairo_t* cr) const {
+    if (!m_surface || isEmpty()) {
+        return;
+    }
+
+    // cairo回放recording surface时会写入它的内部状态（延迟建立的包围盒树和共享的索引缓冲），
+    // 同一个记录不能在多个线程同时回放
+    std::lock_guard<std::mutex> lock(m_replayMutex);
+    cairo_save(cr);
+    cairo_set_source_surface(cr, m_surface, 0, 0);
+    cairo_paint(cr);
+    cairo_restore(cr);
+}
+
+// ====================================================================
+// SDisplayList
+// ====================================================================
+
+void SDisplayList::save() {
+    DisplayOp op;
+    op.type = DisplayOpType::Save;
+    m_ops.push_back(std::move(op));
+}
+
+void SDisplayList::restore() {
+    DisplayOp op;
+    op.type = DisplayOpType::Restore;
+    m_ops.push_back(std::move(op));
+}
+
+void SDisplayList::translate(double x, double y) {
+    DisplayOp op;
+    op.type = DisplayOpType::Translate;
+    op.x = x;
+    op.y = y;
+    m_ops.push_back(std::move(op));
+}
+
+void SDisplayList::clipRect(double x, double y, double width, double height) {
+    DisplayOp op;
+    op.type = DisplayOpType::ClipRect;
+    op.x = x;
+    op.y = y;
+    op.width = width;
+    op.height = height;
+    m_ops.push_back(std::move(op));
+}
+
+void SDisplayList::drawRecording(const SRecordingPtr& recording) {
+    if (!recording || recording->isEmpty()) {
+        return;
+    }
+    DisplayOp op;
+    op.type = DisplayOpType::DrawRecording;
+    op.recording = recording;
+    m_ops.push_back(std::move(op));
+}
+
+void SDisplayList::drawSurface(cairo_surface_t* surface, double x, double y) {
+    if (!surface) {
+        return;
+    }
+    // 多个图块会同时读取同一个层表面，加入列表前完成所有待写入的绘制
+    cairo_surface_flush(surface);
+
+    DisplayOp op;
+    op.type = DisplayOpType::DrawSurface;
+    op.x = x;
+    op.y = y;
+    op.surface = std::shared_ptr<cairo_surface_t>(cairo_surface_reference(surface), cairo_surface_destroy);
+    m_ops.push_back(std::move(op));
+}
+
+void SDisplayList::replay(cairo_t* cr) const {
+    if (!cr) {
+        return;
+    }
+
+    for (const auto& op : m_ops) {
+        switch (op.type) {
+        case DisplayOpType::Save:
+            cairo_save(cr);
+            break;
+        case DisplayOpType::Restore:
+            cairo_restore(cr);
+            break;
+        case DisplayOpType::Translate:
+            cairo_translate(cr, op.x, op.y);
+            break;
+        case DisplayOpType::ClipRect:
+            cairo_rectangle(cr, op.x, op.y, op.width, op.height);
+            cairo_clip(cr);
+            break;
+        case DisplayOpType::DrawRecording:
+            op.recording->replay(cr);
+            break;
+        case DisplayOpType::DrawSurface:
+            // 层缓存按设备像素对齐，在设备坐标系中贴图
+            cairo_save(cr);
+            cairo_identity_matrix(cr);
+            cairo_set_source_surface(cr, op.surface.get(), op.x, op.y);
+            cairo_paint(cr);
+            cairo_restore(cr);
+            break;
+        }
+    }
+}
+
+} // namespace sgui
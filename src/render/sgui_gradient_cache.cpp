@@ -0,0 +1,132 @@
+/**
+ * 渐变图案缓存实现
+ */
+
+#include "sgui_gradient_cache.h"
+#include <algorithm>
+#include <cmath>
+
+namespace sgui {
+
+SGradientCache& SGradientCache::instance() {
+    // 不在进程退出时析构，静态对象持有的控件析构时仍然可以使用缓存
+    static SGradientCache* cache = new SGradientCache();
+    return *cache;
+}
+
+SGradientCache::~SGradientCache() {
+    clear();
+}
+
+cairo_pattern_t* SGradientCache::acquire(const BackgroundGradient& gradient, double width, double height) {
+    if (gradient.stops.empty()) {
+        return nullptr;
+    }
+
+    std::string key = makeKey(gradient, width, height);
+    auto it = m_patterns.find(key);
+    if (it != m_patterns.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+        m_hits++;
+        return cairo_pattern_reference(it->second.pattern);
+    }
+
+    m_misses++;
+    cairo_pattern_t* pattern = create(gradient, width, height);
+    if (m_capacity == 0) {
+        return pattern;
+    }
+    m_lru.push_front(key);
+    m_patterns[key] = Slot{cairo_pattern_reference(pattern), m_lru.begin()};
+    evict();
+    return pattern;
+}
+
+cairo_pattern_t* SGradientCache::create(const BackgroundGradient& gradient, double width, double height) {
+    if (gradient.stops.empty()) {
+        return nullptr;
+    }
+
+    double cx = width / 2.0;
+    double cy = height / 2.0;
+    cairo_pattern_t* pattern;
+    if (gradient.type == GradientType::Radial) {
+        // 单位圆上的径向渐变，通过图案矩阵拉伸为经过四个角的椭圆
+        pattern = cairo_pattern_create_radial(0.0, 0.0, 0.0, 0.0, 0.0, 1.0);
+        double rx = std::max(cx * M_SQRT2, 1e-3);
+        double ry = std::max(cy * M_SQRT2, 1e-3);
+        cairo_matrix_t matrix;
+        cairo_matrix_init_scale(&matrix, 1.0 / rx, 1.0 / ry);
+        cairo_matrix_translate(&matrix, -cx, -cy);
+        cairo_pattern_set_matrix(pattern, &matrix);
+    } else {
+        // 渐变线经过区域中心，方向由角度决定，长度使最远的两个角分别落在起点和终点的垂线上
+        double radians = gradient.angle * M_PI / 180.0;
+        double dx = std::sin(radians);
+        double dy = -std::cos(radians);
+        double half = (std::fabs(width * dx) + std::fabs(height * dy)) / 2.0;
+        pattern = cairo_pattern_create_linear(cx - dx * half, cy - dy * half, cx + dx * half, cy + dy * half);
+    }
+
+    for (const auto& stop : gradient.stops) {
+        cairo_pattern_add_color_stop_rgba(pattern, stop.position, stop.color.r, stop.color.g, stop.color.b, stop.color.a);
+    }
+    return pattern;
+}
+
+void SGradientCache::setCapacity(size_t capacity) {
+    m_capacity = capacity;
+    evict();
+}
+
+GradientCacheStats SGradientCache::getStats() const {
+    GradientCacheStats stats;
+    stats.patternCount = m_patterns.size();
+    stats.capacity = m_capacity;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictions = m_evictions;
+    return stats;
+}
+
+void SGradientCache::clear() {
+    for (auto& pair : m_patterns) {
+        cairo_pattern_destroy(pair.second.pattern);
+    }
+    m_patterns.clear();
+    m_lru.clear();
+}
+
+std::string SGradientCache::makeKey(const BackgroundGradient& gradient, double width, double height) {
+    // 把影响图案的所有参数按字节拼接为键
+    std::string key;
+    key.reserve(sizeof(int) + sizeof(float) + 2 * sizeof(double) + gradient.stops.size() * (4 * sizeof(double) + sizeof(float)));
+    auto append = [&key](const void* data, size_t size) { key.append(static_cast<const char*>(data), size); };
+
+    int type = static_cast<int>(gradient.type);
+    float angle = gradient.type == GradientType::Linear ? gradient.angle : 0.0f;
+    append(&type, sizeof(type));
+    append(&angle, sizeof(angle));
+    append(&width, sizeof(width));
+    append(&height, sizeof(height));
+    for (const auto& stop : gradient.stops) {
+        append(&stop.color.r, sizeof(double));
+        append(&stop.color.g, sizeof(double));
+        append(&stop.color.b, sizeof(double));
+        append(&stop.color.a, sizeof(double));
+        append(&stop.position, sizeof(float));
+    }
+    return key;
+}
+
+void SGradientCache::evict() {
+    while (m_patterns.size() > m_capacity && !m_lru.empty()) {
+        auto it = m_patterns.find(m_lru.back());
+        cairo_pattern_destroy(it->second.pattern);
+        m_patterns.erase(it);
+        m_lru.pop_back();
+        m_evictions++;
+    }
+}
+
+} // namespace sgui
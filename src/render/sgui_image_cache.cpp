@@ -0,0 +1,267 @@
+/**
+ * 图像缓存实现
+ */
+
+#include "sgui_image_cache.h"
+#include "sgui_thread_pool.h"
+#include <algorithm>
+#include <system_error>
+
+namespace sgui {
+
+// ====================================================================
+// SImageRequest
+// ====================================================================
+
+SImageRequest::SImageRequest(const std::string& path, ImageDecodePriority priority, std::function<void()> onReady)
+    : m_path(path), m_onReady(std::move(onReady)), m_priority(static_cast<int>(priority)) {
+}
+
+SImageRequest::~SImageRequest() {
+    if (m_surface) {
+        cairo_surface_destroy(m_surface);
+    }
+}
+
+// ====================================================================
+// SImageCache
+// ====================================================================
+
+SImageCache& SImageCache::instance() {
+    // 不在进程退出时析构，静态对象持有的控件析构时仍然可以使用缓存
+    static SImageCache* cache = new SImageCache();
+    return *cache;
+}
+
+SImageCache::~SImageCache() {
+    clear();
+}
+
+cairo_surface_t* SImageCache::acquire(const std::string& path) {
+    if (path.empty()) {
+        return nullptr;
+    }
+
+    std::error_code ec;
+    auto modified = std::filesystem::last_write_time(path, ec);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        cairo_surface_t* cached = lookupLocked(path, !ec, modified);
+        if (cached) {
+            return cached;
+        }
+        m_misses++;
+    }
+
+    // 解码不持有锁，其他线程可以同时使用缓存；同一路径同时解码时保留后完成的结果
+    cairo_surface_t* surface = cairo_image_surface_create_from_png(path.c_str());
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(surface);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_failures++;
+        return nullptr;
+    }
+    if (ec) {
+        // 无法获取修改时间时仍然返回图像，但不缓存
+        return surface;
+    }
+
+    size_t bytes = static_cast<size_t>(cairo_image_surface_get_stride(surface)) *
+                   static_cast<size_t>(cairo_image_surface_get_height(surface));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    removeLocked(path);
+    if (bytes > m_budget) {
+        // 单个图像超过整个预算时不缓存
+        return surface;
+    }
+    m_lru.push_front(path);
+    Entry entry;
+    entry.surface = cairo_surface_reference(surface);
+    entry.modified = modified;
+    entry.bytes = bytes;
+    entry.lru = m_lru.begin();
+    m_images[path] = entry;
+    m_bytes += bytes;
+    evictLocked();
+    return surface;
+}
+
+cairo_surface_t* SImageCache::lookup(const std::string& path) {
+    if (path.empty()) {
+        return nullptr;
+    }
+
+    std::error_code ec;
+    auto modified = std::filesystem::last_write_time(path, ec);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return lookupLocked(path, !ec, modified);
+}
+
+SImageRequestPtr SImageCache::requestAsync(const std::string& path, ImageDecodePriority priority,
+                                           std::function<void()> onReady) {
+    auto request = std::make_shared<SImageRequest>(path, priority, std::move(onReady));
+
+    bool first;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_asyncRequests++;
+        PendingDecode& pending = m_pending[path];
+        first = pending.requests.empty();
+        if (first) {
+            pending.sequence = m_nextSequence++;
+        }
+        pending.requests.push_back(request);
+    }
+
+    // 每个等待的图像对应一个工作任务，任务执行时才决定解码哪个图像，因此后提交的高优先级图像可以先解码；
+    // 完成回调只在UI线程执行，回调访问的控件不会在执行过程中被其他线程析构
+    if (first) {
+        SThreadPool::instance().submit([this]() {
+            std::vector<SImageRequestPtr> requests = decodeNext();
+            SThreadPool::postCompletion([requests]() {
+                for (const auto& request : requests) {
+                    if (!request->isCancelled() && request->m_onReady) {
+                        request->m_onReady();
+                    }
+                }
+            });
+        });
+    }
+    return request;
+}
+
+bool SImageCache::isAsyncDecode() const {
+    return m_asyncDecode && SThreadPool::hasCompletionDispatcher();
+}
+
+std::vector<SImageRequestPtr> SImageCache::decodeNext() {
+    std::string path;
+    std::vector<SImageRequestPtr> requests;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto best = m_pending.end();
+        int bestPriority = -1;
+        for (auto it = m_pending.begin(); it != m_pending.end();) {
+            // 丢弃已取消的请求，全部取消的图像不再解码
+            auto& waiting = it->second.requests;
+            size_t before = waiting.size();
+            waiting.erase(std::remove_if(waiting.begin(), waiting.end(),
+                                         [](const SImageRequestPtr& request) { return request->isCancelled(); }),
+                          waiting.end());
+            m_asyncCancelled += before - waiting.size();
+            if (waiting.empty()) {
+                it = m_pending.erase(it);
+                continue;
+            }
+
+            int priority = 0;
+            for (const auto& request : waiting) {
+                priority = std::max(priority, request->m_priority.load());
+            }
+            if (priority > bestPriority ||
+                (priority == bestPriority && it->second.sequence < best->second.sequence)) {
+                best = it;
+                bestPriority = priority;
+            }
+            ++it;
+        }
+        if (best == m_pending.end()) {
+            return requests;
+        }
+        path = best->first;
+        requests = std::move(best->second.requests);
+        m_pending.erase(best);
+    }
+
+    cairo_surface_t* surface = acquire(path);
+    for (const auto& request : requests) {
+        request->m_surface = surface ? cairo_surface_reference(surface) : nullptr;
+        request->m_done.store(true, std::memory_order_release);
+    }
+    if (surface) {
+        cairo_surface_destroy(surface);
+    }
+    return requests;
+}
+
+void SImageCache::setBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = bytes;
+    evictLocked();
+}
+
+size_t SImageCache::getBudget() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_budget;
+}
+
+ImageCacheStats SImageCache::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ImageCacheStats stats;
+    stats.imageCount = m_images.size();
+    stats.bytes = m_bytes;
+    stats.budget = m_budget;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictions = m_evictions;
+    stats.failures = m_failures;
+    stats.asyncRequests = m_asyncRequests;
+    stats.asyncCancelled = m_asyncCancelled;
+    stats.asyncPending = m_pending.size();
+    return stats;
+}
+
+void SImageCache::remove(const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    removeLocked(path);
+}
+
+void SImageCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& pair : m_images) {
+        cairo_surface_destroy(pair.second.surface);
+    }
+    m_images.clear();
+    m_lru.clear();
+    m_bytes = 0;
+}
+
+cairo_surface_t* SImageCache::lookupLocked(const std::string& path, bool hasModified,
+                                           const std::filesystem::file_time_type& modified) {
+    auto it = m_images.find(path);
+    if (it == m_images.end()) {
+        return nullptr;
+    }
+    if (!hasModified || it->second.modified != modified) {
+        // 文件已被修改或删除，旧图像不再有效
+        removeLocked(path);
+        return nullptr;
+    }
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+    m_hits++;
+    return cairo_surface_reference(it->second.surface);
+}
+
+void SImageCache::removeLocked(const std::string& path) {
+    auto it = m_images.find(path);
+    if (it == m_images.end()) {
+        return;
+    }
+    cairo_surface_destroy(it->second.surface);
+    m_bytes -= it->second.bytes;
+    m_lru.erase(it->second.lru);
+    m_images.erase(it);
+}
+
+void SImageCache::evictLocked() {
+    // 从最久未使用的图像开始淘汰，仍在使用的表面由使用者的引用保持有效
+    while (m_bytes > m_budget && !m_lru.empty()) {
+        std::string path = m_lru.back();
+        removeLocked(path);
+        m_evictions++;
+    }
+}
+
+} // namespace sgui
@@ -0,0 +1,96 @@
+/**
+ * 层缓存实现
+ */
+
+#include "sgui_layer_cache.h"
+
+namespace sgui {
+
+SLayerCache& SLayerCache::instance() {
+    // 不在进程退出时析构，静态对象持有的控件析构时仍然可以释放自己的层
+    static SLayerCache* cache = new SLayerCache();
+    return *cache;
+}
+
+SLayerCache::~SLayerCache() {
+    clear();
+}
+
+void SLayerCache::setBudget(size_t bytes) {
+    m_budget = bytes;
+    evict();
+}
+
+LayerCacheStats SLayerCache::getStats() const {
+    LayerCacheStats stats;
+    stats.layerCount = m_layers.size();
+    stats.bytes = m_bytes;
+    stats.budget = m_budget;
+    stats.hits = m_hits;
+    stats.renders = m_renders;
+    stats.evictions = m_evictions;
+    stats.rejected = m_rejected;
+    return stats;
+}
+
+void SLayerCache::clear() {
+    for (auto& pair : m_layers) {
+        cairo_surface_destroy(pair.second.entry.surface);
+    }
+    m_layers.clear();
+    m_lru.clear();
+    m_bytes = 0;
+}
+
+const LayerEntry* SLayerCache::find(const SLayout* owner) const {
+    auto it = m_layers.find(owner);
+    return it != m_layers.end() ? &it->second.entry : nullptr;
+}
+
+void SLayerCache::touch(const SLayout* owner) {
+    auto it = m_layers.find(owner);
+    if (it == m_layers.end()) {
+        return;
+    }
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+    m_hits++;
+}
+
+bool SLayerCache::store(const SLayout* owner, const LayerEntry& entry) {
+    remove(owner);
+    m_renders++;
+
+    if (entry.bytes > m_budget) {
+        cairo_surface_destroy(entry.surface);
+        m_rejected++;
+        return false;
+    }
+
+    m_lru.push_front(owner);
+    m_layers[owner] = Slot{entry, m_lru.begin()};
+    m_bytes += entry.bytes;
+    evict();
+    return true;
+}
+
+void SLayerCache::remove(const SLayout* owner) {
+    auto it = m_layers.find(owner);
+    if (it == m_layers.end()) {
+        return;
+    }
+    cairo_surface_destroy(it->second.entry.surface);
+    m_bytes -= it->second.entry.bytes;
+    m_lru.erase(it->second.lru);
+    m_layers.erase(it);
+}
+
+void SLayerCache::evict() {
+    // 从最久未使用的层开始淘汰；刚保存的层在最前面，只有它本身超过预算时才会被淘汰，store已经排除了这种情况
+    while (m_bytes > m_budget && !m_lru.empty()) {
+        const SLayout* owner = m_lru.back();
+        remove(owner);
+        m_evictions++;
+    }
+}
+
+} // namespace sgui
@@ -0,0 +1,49 @@
+/**
+ * 呈现矩形合并实现
+ */
+
+#include "internal/sgui_present_rects.h"
+#include <algorithm>
+
+namespace sgui {
+
+namespace {
+
+int64_t rectArea(const cairo_rectangle_int_t& rect) {
+    return static_cast<int64_t>(rect.width) * rect.height;
+}
+
+cairo_rectangle_int_t unionRect(const cairo_rectangle_int_t& a, const cairo_rectangle_int_t& b) {
+    int x0 = std::min(a.x, b.x);
+    int y0 = std::min(a.y, b.y);
+    int x1 = std::max(a.x + a.width, b.x + b.width);
+    int y1 = std::max(a.y + a.height, b.y + b.height);
+    return {x0, y0, x1 - x0, y1 - y0};
+}
+
+} // namespace
+
+void mergePresentRects(std::vector<cairo_rectangle_int_t>& rects, size_t maxRects) {
+    while (rects.size() > 1) {
+        size_t bestI = 0, bestJ = 1;
+        int64_t bestWaste = INT64_MAX;
+        for (size_t i = 0; i < rects.size(); ++i) {
+            for (size_t j = i + 1; j < rects.size(); ++j) {
+                int64_t waste = rectArea(unionRect(rects[i], rects[j])) - rectArea(rects[i]) - rectArea(rects[j]);
+                if (waste < bestWaste) {
+                    bestWaste = waste;
+                    bestI = i;
+                    bestJ = j;
+                }
+            }
+        }
+
+        if (bestWaste > kPresentRectOverhead && rects.size() <= maxRects) {
+            break;
+        }
+        rects[bestI] = unionRect(rects[bestI], rects[bestJ]);
+        rects.erase(rects.begin() + bestJ);
+    }
+}
+
+} // namespace sgui
@@ -0,0 +1,105 @@
+/**
+ * 窗口渲染线程实现
+ */
+
+#include "internal/sgui_render_thread.h"
+#include "sgui_cairo_renderer.h"
+
+namespace sgui {
+
+SRenderThread::SRenderThread(SCairoRenderer* renderer)
+    : m_renderer(renderer) {
+    m_thread = std::thread(&SRenderThread::threadMain, this);
+}
+
+SRenderThread::~SRenderThread() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void SRenderThread::commit(FrameSnapshot snapshot) {
+    // 过时的快照在锁外释放
+    FrameSnapshot stale;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_hasPending) {
+            // 渲染线程还没取走上一帧，上一帧已经过时
+            stale = std::move(m_pending);
+            m_droppedFrames++;
+        }
+        m_pending = std::move(snapshot);
+        m_hasPending = true;
+    }
+    m_cv.notify_one();
+}
+
+void SRenderThread::resizeRenderer(int width, int height) {
+    std::lock_guard<std::mutex> lock(m_rendererMutex);
+    m_renderer->resize(width, height);
+}
+
+void SRenderThread::waitIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idleCv.wait(lock, [this] { return m_stop || (!m_hasPending && !m_busy); });
+}
+
+uint64_t SRenderThread::getRasterizedFrames() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_rasterizedFrames;
+}
+
+uint64_t SRenderThread::getDroppedFrames() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_droppedFrames;
+}
+
+void SRenderThread::threadMain() {
+    while (true) {
+        FrameSnapshot snapshot;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_stop || m_hasPending; });
+            if (m_stop) {
+                return;
+            }
+            snapshot = std::move(m_pending);
+            m_pending = FrameSnapshot();
+            m_hasPending = false;
+            m_busy = true;
+        }
+
+        rasterize(snapshot);
+        snapshot = FrameSnapshot();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_rasterizedFrames++;
+            m_busy = false;
+        }
+        m_idleCv.notify_all();
+    }
+}
+
+void SRenderThread::rasterize(const FrameSnapshot& snapshot) {
+    if (!snapshot.displayList) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_rendererMutex);
+
+    // 回放快照中的绘制命令到后缓冲（按图块并行光栅化），然后呈现到窗口
+    m_renderer->begin();
+    cairo_rectangle_int_t bounds = {0, 0, snapshot.width, snapshot.height};
+    cairo_region_t* region = cairo_region_create_rectangle(&bounds);
+    m_renderer->rasterize(*snapshot.displayList, region);
+    cairo_region_destroy(region);
+    m_renderer->end();
+}
+
+} // namespace sgui
@@ -0,0 +1,258 @@
+/**
+ * 阴影遮罩缓存实现
+ */
+
+#include "sgui_shadow_cache.h"
+#include "internal/sgui_blur.h"
+#include <algorithm>
+#include <cmath>
+
+namespace sgui {
+
+namespace {
+
+// 圆角矩形路径，圆角半径不超过边长的一半
+void appendRoundedRect(cairo_t* cr, double x, double y, double width, double height, const ShadowShape& shape) {
+    double limit = std::min(width, height) / 2.0;
+    double tl = std::min(shape.radiusTopLeft, limit);
+    double tr = std::min(shape.radiusTopRight, limit);
+    double br = std::min(shape.radiusBottomRight, limit);
+    double bl = std::min(shape.radiusBottomLeft, limit);
+
+    cairo_new_sub_path(cr);
+    cairo_arc(cr, x + width - tr, y + tr, tr, -M_PI / 2, 0);
+    cairo_arc(cr, x + width - br, y + height - br, br, 0, M_PI / 2);
+    cairo_arc(cr, x + bl, y + height - bl, bl, M_PI / 2, M_PI);
+    cairo_arc(cr, x + tl, y + tl, tl, M_PI, 3 * M_PI / 2);
+    cairo_close_path(cr);
+}
+
+// 九宫格中一个切片的水平或垂直方向的划分
+struct Slice {
+    double dest0, dest1; // 目标范围
+    int src, size;       // 遮罩中的范围
+    double origin;       // 遮罩切片起点对应的目标坐标
+    double scale;        // 目标到遮罩的缩放
+};
+
+} // namespace
+
+SShadowCache& SShadowCache::instance() {
+    // 不在进程退出时析构，静态对象持有的控件析构时仍然可以使用缓存
+    static SShadowCache* cache = new SShadowCache();
+    return *cache;
+}
+
+SShadowCache::~SShadowCache() {
+    clear();
+}
+
+int SShadowCache::blurExtent(double blurRadius) {
+    return gaussianBlurExtent(blurRadius / 2.0);
+}
+
+void SShadowCache::draw(cairo_t* cr, const ShadowShape& shape, double x, double y) {
+    if (shape.width <= 0.0 || shape.height <= 0.0) {
+        return;
+    }
+
+    const Mask& mask = acquire(shape);
+    int margin = blurExtent(shape.blurRadius);
+
+    // 遮罩在目标中的范围：九宫格遮罩拉伸到形状尺寸，按目标尺寸生成的遮罩1:1绘制
+    double x0 = x - margin;
+    double y0 = y - margin;
+    double x1 = mask.exact ? x0 + mask.width : x + shape.width + margin;
+    double y1 = mask.exact ? y0 + mask.height : y + shape.height + margin;
+
+    // 两侧的切片延伸到裁剪范围的边缘，遮罩边缘的像素（外阴影为0，内阴影为不透明）向外延伸
+    double clipX0, clipY0, clipX1, clipY1;
+    cairo_clip_extents(cr, &clipX0, &clipY0, &clipX1, &clipY1);
+
+    auto makeSlices = [](double lo, double hi, double start, double end, int total, int first, int last, Slice out[3]) {
+        double middle0 = start + first;
+        double middle1 = end - last;
+        int middle = total - first - last;
+        out[0] = {std::min(lo, start), middle0, 0, first, start, 1.0};
+        out[1] = {middle0, middle1, first, middle, middle0, middle1 > middle0 ? middle / (middle1 - middle0) : 1.0};
+        out[2] = {middle1, std::max(hi, end), total - last, last, middle1, 1.0};
+    };
+    Slice columns[3];
+    Slice rows[3];
+    makeSlices(clipX0, clipX1, x0, x1, mask.width, mask.sliceLeft, mask.sliceRight, columns);
+    makeSlices(clipY0, clipY1, y0, y1, mask.height, mask.sliceTop, mask.sliceBottom, rows);
+
+    for (const Slice& row : rows) {
+        for (const Slice& column : columns) {
+            if (row.size <= 0 || column.size <= 0 || row.dest1 <= row.dest0 || column.dest1 <= column.dest0) {
+                continue;
+            }
+
+            // 子表面限制采样范围，拉伸时不会混入相邻切片的像素
+            cairo_surface_t* slice = cairo_surface_create_for_rectangle(mask.surface, column.src, row.src, column.size, row.size);
+            cairo_pattern_t* pattern = cairo_pattern_create_for_surface(slice);
+            cairo_pattern_set_extend(pattern, CAIRO_EXTEND_PAD);
+            cairo_matrix_t matrix;
+            cairo_matrix_init_scale(&matrix, column.scale, row.scale);
+            cairo_matrix_translate(&matrix, -column.origin, -row.origin);
+            cairo_pattern_set_matrix(pattern, &matrix);
+
+            // 切片之间按像素中心划分，不产生抗锯齿接缝
+            cairo_save(cr);
+            cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
+            cairo_rectangle(cr, column.dest0, row.dest0, column.dest1 - column.dest0, row.dest1 - row.dest0);
+            cairo_clip(cr);
+            cairo_mask(cr, pattern);
+            cairo_restore(cr);
+
+            cairo_pattern_destroy(pattern);
+            cairo_surface_destroy(slice);
+        }
+    }
+}
+
+void SShadowCache::setBudget(size_t bytes) {
+    m_budget = bytes;
+    evict();
+}
+
+ShadowCacheStats SShadowCache::getStats() const {
+    ShadowCacheStats stats;
+    stats.maskCount = m_masks.size();
+    stats.bytes = m_bytes;
+    stats.budget = m_budget;
+    stats.hits = m_hits;
+    stats.blurs = m_blurs;
+    stats.evictions = m_evictions;
+    return stats;
+}
+
+void SShadowCache::clear() {
+    for (auto& pair : m_masks) {
+        cairo_surface_destroy(pair.second.surface);
+    }
+    m_masks.clear();
+    m_lru.clear();
+    m_bytes = 0;
+}
+
+const SShadowCache::Mask& SShadowCache::acquire(const ShadowShape& shape) {
+    // 形状足够大时四个角的模糊互不影响，可以使用只和圆角、模糊半径有关的九宫格遮罩；
+    // 否则按目标尺寸生成遮罩
+    int margin = blurExtent(shape.blurRadius);
+    double left = std::ceil(std::max(shape.radiusTopLeft, shape.radiusBottomLeft));
+    double right = std::ceil(std::max(shape.radiusTopRight, shape.radiusBottomRight));
+    double top = std::ceil(std::max(shape.radiusTopLeft, shape.radiusTopRight));
+    double bottom = std::ceil(std::max(shape.radiusBottomLeft, shape.radiusBottomRight));
+    bool exact = shape.width < left + right + 2 * margin + 1 || shape.height < top + bottom + 2 * margin + 1;
+
+    // 影响遮罩的所有参数按字节拼接为键
+    std::string key;
+    auto append = [&key](const void* data, size_t size) { key.append(static_cast<const char*>(data), size); };
+    append(&shape.radiusTopLeft, sizeof(double));
+    append(&shape.radiusTopRight, sizeof(double));
+    append(&shape.radiusBottomRight, sizeof(double));
+    append(&shape.radiusBottomLeft, sizeof(double));
+    append(&shape.blurRadius, sizeof(double));
+    append(&shape.inset, sizeof(bool));
+    if (exact) {
+        append(&shape.width, sizeof(double));
+        append(&shape.height, sizeof(double));
+    }
+
+    auto it = m_masks.find(key);
+    if (it != m_masks.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+        m_hits++;
+        return it->second;
+    }
+
+    Mask mask = createMask(shape, exact);
+    m_blurs++;
+    m_lru.push_front(key);
+    mask.lru = m_lru.begin();
+    m_bytes += mask.bytes;
+    const Mask& stored = m_masks.emplace(key, mask).first->second;
+
+    // 刚生成的遮罩在最前面，即使超过预算也保留到下次使用其他遮罩时才淘汰
+    while (m_bytes > m_budget && m_lru.size() > 1) {
+        remove(m_lru.back());
+        m_evictions++;
+    }
+    return stored;
+}
+
+SShadowCache::Mask SShadowCache::createMask(const ShadowShape& shape, bool exact) {
+    int margin = blurExtent(shape.blurRadius);
+    int left = static_cast<int>(std::ceil(std::max(shape.radiusTopLeft, shape.radiusBottomLeft)));
+    int right = static_cast<int>(std::ceil(std::max(shape.radiusTopRight, shape.radiusBottomRight)));
+    int top = static_cast<int>(std::ceil(std::max(shape.radiusTopLeft, shape.radiusTopRight)));
+    int bottom = static_cast<int>(std::ceil(std::max(shape.radiusBottomLeft, shape.radiusBottomRight)));
+
+    Mask mask;
+    double shapeWidth, shapeHeight;
+    if (exact) {
+        // 按目标尺寸生成，两侧各留1像素切片，用于向外延伸
+        shapeWidth = shape.width;
+        shapeHeight = shape.height;
+        mask.width = static_cast<int>(std::ceil(shapeWidth)) + 2 * margin;
+        mask.height = static_cast<int>(std::ceil(shapeHeight)) + 2 * margin;
+        mask.sliceLeft = std::min(1, mask.width);
+        mask.sliceRight = std::min(1, mask.width - mask.sliceLeft);
+        mask.sliceTop = std::min(1, mask.height);
+        mask.sliceBottom = std::min(1, mask.height - mask.sliceTop);
+    } else {
+        // 最小的形状：圆角和两侧的模糊范围之间留出1像素，这一列（行）的模糊结果只与到直边的距离有关
+        shapeWidth = left + right + 2 * margin + 1;
+        shapeHeight = top + bottom + 2 * margin + 1;
+        mask.width = static_cast<int>(shapeWidth) + 2 * margin;
+        mask.height = static_cast<int>(shapeHeight) + 2 * margin;
+        mask.sliceLeft = left + 2 * margin;
+        mask.sliceRight = right + 2 * margin;
+        mask.sliceTop = top + 2 * margin;
+        mask.sliceBottom = bottom + 2 * margin;
+    }
+    mask.exact = exact;
+
+    mask.surface = cairo_image_surface_create(CAIRO_FORMAT_A8, mask.width, mask.height);
+    cairo_t* cr = cairo_create(mask.surface);
+    if (shape.inset) {
+        // 内阴影：洞以外不透明，洞的边缘模糊后渗入洞内
+        cairo_set_source_rgba(cr, 0, 0, 0, 1);
+        cairo_paint(cr);
+        cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+    } else {
+        cairo_set_source_rgba(cr, 0, 0, 0, 1);
+    }
+    appendRoundedRect(cr, margin, margin, shapeWidth, shapeHeight, shape);
+    cairo_fill(cr);
+    cairo_destroy(cr);
+
+    cairo_surface_flush(mask.surface);
+    gaussianBlurA8(cairo_image_surface_get_data(mask.surface), mask.width, mask.height,
+                   cairo_image_surface_get_stride(mask.surface), shape.blurRadius / 2.0);
+    cairo_surface_mark_dirty(mask.surface);
+
+    mask.bytes = static_cast<size_t>(cairo_image_surface_get_stride(mask.surface)) * mask.height;
+    return mask;
+}
+
+void SShadowCache::remove(const std::string& key) {
+    auto it = m_masks.find(key);
+    if (it == m_masks.end()) {
+        return;
+    }
+    cairo_surface_destroy(it->second.surface);
+    m_bytes -= it->second.bytes;
+    m_lru.erase(it->second.lru);
+    m_masks.erase(it);
+}
+
+void SShadowCache::evict() {
+    while (m_bytes > m_budget && !m_lru.empty()) {
+        remove(m_lru.back());
+        m_evictions++;
+    }
+}
+
+} // namespace sgui
@@ -0,0 +1,172 @@
+/**
+ * X11共享内存（MIT-SHM）呈现器实现
+ */
+
+#include "internal/sgui_xshm_presenter.h"
+
+#ifdef SGUI_HAVE_XSHM
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <cstdint>
+#include <iostream>
+
+namespace sgui {
+
+namespace {
+
+// XShmAttach的错误是异步报告的，需要临时安装错误处理函数捕获
+bool g_attachFailed = false;
+
+int attachErrorHandler(::Display* display, XErrorEvent* event) {
+    (void)display;
+    (void)event;
+    g_attachFailed = true;
+    return 0;
+}
+
+bool isHostLittleEndian() {
+    const uint16_t value = 1;
+    return *reinterpret_cast<const uint8_t*>(&value) == 1;
+}
+
+} // namespace
+
+std::unique_ptr<SXShmPresenter> SXShmPresenter::create(::Display* display, ::Drawable drawable, ::Visual* visual,
+                                                       int depth, int width, int height) {
+    if (!display || !drawable || !visual || width <= 0 || height <= 0) {
+        return nullptr;
+    }
+
+    // 远程连接或者服务器没有启用扩展
+    if (!XShmQueryExtension(display)) {
+        return nullptr;
+    }
+
+    // 后缓冲直接作为XImage的像素，格式必须与CAIRO_FORMAT_ARGB32一致
+    if ((depth != 24 && depth != 32) || visual->red_mask != 0xff0000 || visual->green_mask != 0x00ff00 ||
+        visual->blue_mask != 0x0000ff) {
+        return nullptr;
+    }
+
+    std::unique_ptr<SXShmPresenter> presenter(new SXShmPresenter());
+    presenter->m_display = display;
+    presenter->m_drawable = drawable;
+    presenter->m_width = width;
+    presenter->m_height = height;
+    presenter->m_shmInfo.shmid = -1;
+    presenter->m_shmInfo.shmaddr = reinterpret_cast<char*>(-1);
+
+    XImage* image = XShmCreateImage(display, visual, depth, ZPixmap, nullptr, &presenter->m_shmInfo, width, height);
+    if (!image) {
+        return nullptr;
+    }
+    presenter->m_image = image;
+
+    int hostOrder = isHostLittleEndian() ? LSBFirst : MSBFirst;
+    if (image->bits_per_pixel != 32 || image->byte_order != hostOrder || image->bytes_per_line % 4 != 0) {
+        return nullptr;
+    }
+
+    size_t size = static_cast<size_t>(image->bytes_per_line) * image->height;
+    presenter->m_shmInfo.shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+    if (presenter->m_shmInfo.shmid < 0) {
+        return nullptr;
+    }
+
+    presenter->m_shmInfo.shmaddr = static_cast<char*>(shmat(presenter->m_shmInfo.shmid, nullptr, 0));
+    if (presenter->m_shmInfo.shmaddr == reinterpret_cast<char*>(-1)) {
+        return nullptr;
+    }
+    image->data = presenter->m_shmInfo.shmaddr;
+    presenter->m_shmInfo.readOnly = False;
+
+    // 同步等待服务器处理attach请求，以便捕获错误
+    XSync(display, False);
+    g_attachFailed = false;
+    auto oldHandler = XSetErrorHandler(attachErrorHandler);
+    Status status = XShmAttach(display, &presenter->m_shmInfo);
+    XSync(display, False);
+    XSetErrorHandler(oldHandler);
+    if (!status || g_attachFailed) {
+        return nullptr;
+    }
+    presenter->m_attached = true;
+
+    // 双方都分离后由系统自动删除共享内存段，进程异常退出也不会泄漏
+    shmctl(presenter->m_shmInfo.shmid, IPC_RMID, nullptr);
+
+    presenter->m_gc = XCreateGC(display, drawable, 0, nullptr);
+    presenter->m_completionType = XShmGetEventBase(display) + ShmCompletion;
+
+    std::cout << "Using MIT-SHM present path (" << width << "x" << height << ")" << std::endl;
+    return presenter;
+}
+
+SXShmPresenter::~SXShmPresenter() {
+    if (m_attached) {
+        waitIdle();
+        XShmDetach(m_display, &m_shmInfo);
+        XSync(m_display, False);
+    }
+
+    if (m_image) {
+        // 像素内存属于共享内存段，不能由XDestroyImage释放
+        m_image->data = nullptr;
+        XDestroyImage(m_image);
+    }
+
+    if (m_shmInfo.shmaddr != reinterpret_cast<char*>(-1) && m_shmInfo.shmaddr != nullptr) {
+        shmdt(m_shmInfo.shmaddr);
+    }
+    if (!m_attached && m_shmInfo.shmid >= 0) {
+        shmctl(m_shmInfo.shmid, IPC_RMID, nullptr);
+    }
+
+    if (m_gc) {
+        XFreeGC(m_display, m_gc);
+    }
+}
+
+unsigned char* SXShmPresenter::getData() const {
+    return reinterpret_cast<unsigned char*>(m_shmInfo.shmaddr);
+}
+
+int SXShmPresenter::getStride() const {
+    return m_image ? m_image->bytes_per_line : 0;
+}
+
+void SXShmPresenter::present(const std::vector<cairo_rectangle_int_t>& rects) {
+    for (const auto& rect : rects) {
+        XShmPutImage(m_display, m_drawable, m_gc, m_image, rect.x, rect.y, rect.x, rect.y,
+                     static_cast<unsigned int>(rect.width), static_cast<unsigned int>(rect.height), True);
+        m_pending++;
+    }
+    XFlush(m_display);
+}
+
+void SXShmPresenter::waitIdle() {
+    while (m_pending > 0) {
+        XEvent event;
+        if (XCheckTypedWindowEvent(m_display, m_drawable, m_completionType, &event)) {
+            m_pending--;
+            m_completed++;
+            continue;
+        }
+
+        // XSync返回时服务器已经处理完之前的所有请求，完成事件也都已进入事件队列；
+        // 共享X连接时事件可能已被其他事件循环取走，此时请求同样已经完成
+        XSync(m_display, False);
+        if (!XCheckTypedWindowEvent(m_display, m_drawable, m_completionType, &event)) {
+            m_completed += m_pending;
+            m_pending = 0;
+            break;
+        }
+        m_pending--;
+        m_completed++;
+    }
+}
+
+} // namespace sgui
+
+#endif // SGUI_HAVE_XSHM
@@ -5,8 +5,13 @@
 #include "sgui_window.h"
 #include "sgui_cairo_renderer.h"
 #include "sgui_container.h"
+#include "sgui_thread_pool.h"
+#include "sgui_timer.h"
+#include "internal/sgui_render_thread.h"
+#include "internal/sgui_task_queue.h"
 #include <GLFW/glfw3.h>
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <thread>
 #include <vector>
@@ -23,21 +28,52 @@
 namespace sgui
 {
 
-SWindow::SWindow(int width, int height, const char *title, SWindowManager *manager) : width_(width), height_(height), title_(title), manager_(manager), window_(nullptr)
+// 存在的窗口管理器，最后创建的是当前管理器：全局的当前定时器服务和线程池完成回调投递都指向它
+static std::vector<SWindowManager *> g_windowManagers;
+
+// 清空区域
+static void clearRegion(cairo_region_t *region)
+{
+    cairo_rectangle_int_t empty = {0, 0, 0, 0};
+    cairo_region_intersect_rectangle(region, &empty);
+}
+
+SWindow::SWindow(int width, int height, const char *title, SWindowManager *manager)
+    : width_(width), height_(height), title_(title), manager_(manager), window_(nullptr), headless_(manager && manager->IsHeadless())
 {
     // 注意：CairoRenderer需要在窗口创建后才能初始化
+    damage_ = cairo_region_create();
 }
 
 SWindow::~SWindow()
 {
+    // 渲染线程和渲染器都引用原生窗口，必须在窗口销毁前释放
+    renderThread_.reset();
+    cairoRenderer_.reset();
+
     if (window_)
     {
         glfwDestroyWindow(window_);
     }
+
+    cairo_region_destroy(damage_);
 }
 
 bool SWindow::Initialize()
 {
+    if (headless_)
+    {
+        // 无窗口模式：渲染器只绘制到内存中的图像表面
+        cairoRenderer_ = std::make_unique<sgui::SCairoRenderer>(nullptr, width_, height_);
+        if (!cairoRenderer_->getBackSurface())
+        {
+            std::cerr << "Failed to create headless renderer for: " << title_ << std::endl;
+            return false;
+        }
+        std::cout << "Created headless window: " << title_ << " (" << width_ << "x" << height_ << ")" << std::endl;
+        return true;
+    }
+
     // 设置窗口提示，不创建OpenGL上下文
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 
@@ -53,6 +89,7 @@ bool SWindow::Initialize()
     glfwSetWindowUserPointer(window_, this);
     glfwSetWindowSizeCallback(window_, WindowSizeCallback);
     glfwSetWindowCloseCallback(window_, WindowCloseCallback);
+    glfwSetWindowRefreshCallback(window_, WindowRefreshCallback);
 
     // 设置鼠标和键盘回调
     glfwSetCursorPosCallback(window_, MousePosCallback);
@@ -65,7 +102,12 @@ bool SWindow::Initialize()
     void *windowId = getWindowId();
     if (windowId)
     {
-        cairoRenderer_ = std::make_unique<sgui::SCairoRenderer>(windowId, width_, height_);
+        // 渲染器共享GLFW的显示连接，避免每个窗口再打开一个X连接
+        void *display = nullptr;
+#ifdef __linux__
+        display = glfwGetX11Display();
+#endif
+        cairoRenderer_ = std::make_unique<sgui::SCairoRenderer>(windowId, width_, height_, display);
         std::cout << "Created simplified Cairo renderer for window: " << title_ << std::endl;
     }
     else
@@ -80,44 +122,355 @@ bool SWindow::Initialize()
 
 void SWindow::Render()
 {
-    if (!window_ || glfwWindowShouldClose(window_))
+    if (ShouldClose())
+        return;
+
+    applyPendingResize();
+
+    if (!rootContainer_ || !cairoRenderer_)
+    {
+        needsRender_ = false;
+        hasPendingInput_ = false;
+        return;
+    }
+
+    // 计算布局并收集损坏区域；没有任何区域需要重绘时跳过绘制和呈现。
+    // 没有改变任何内容的输入（例如悬停在静态控件上）不会被呈现，不记录延迟，
+    // 否则下一次真正的呈现会把其间的空闲时间算作输入延迟
+    if (!collectFrameDamage())
+    {
+        rootContainer_->clearPaintDirty();
+        needsRender_ = false;
+        hasPendingInput_ = false;
         return;
+    }
+    frameStats_.lastDamageArea = damageArea();
 
-    // 如果有根容器，使用双缓冲Cairo渲染
-    if (rootContainer_ && cairoRenderer_)
+    if (renderThread_)
+    {
+        // 光栅化和呈现交给渲染线程；渲染线程可能丢弃过时的快照，所以快照总是包含整个窗口
+        commitFrameSnapshot();
+        notePresented();
+    }
+    else
     {
-        // 开始双缓冲绘制 - 清除后缓冲并准备绘制
+        // 开始双缓冲绘制 - 后缓冲保留上一帧的内容，只重绘损坏区域
         // 所有绘制操作将先在内存中的后缓冲进行，避免直接绘制到窗口造成闪烁
         cairoRenderer_->begin();
 
-        // 计算布局
-        if (rootContainer_->isDirty())
+        // 渲染与损坏区域相交的控件到后缓冲（双缓冲：先绘制到内存）
+        cairo_t *cr = cairoRenderer_->getContext();
+        if (cairoRenderer_->getRasterThreads() != 1)
         {
-            rootContainer_->setWidth(sgui::LayoutValue::Point(width_));
-            rootContainer_->setHeight(sgui::LayoutValue::Point(height_));
-            rootContainer_->calculateLayout(width_, height_);
-            rootContainer_->clearDirty();
+            // 并行光栅化：记录帧显示列表后按图块回放到损坏区域
+            cairo_rectangle_int_t extents;
+            cairo_region_get_extents(damage_, &extents);
+            SDisplayList displayList;
+            rootContainer_->recordDisplayList(displayList, CAIRO_ANTIALIAS_SUBPIXEL,
+                                              Rect(extents.x, extents.y, extents.width, extents.height));
+            cairoRenderer_->rasterize(displayList, damage_);
         }
-
-        // 渲染容器树到后缓冲（双缓冲：先绘制到内存）
-        // 此时所有绘制操作都在内存中的后缓冲进行，用户看不到绘制过程
-        cairo_t *cr = cairoRenderer_->getContext();
-        if (cr)
+        else if (cr)
         {
-            rootContainer_->renderTree(cr);
+            renderDamage(cr);
         }
 
-        // 结束双缓冲绘制 - 将后缓冲内容一次性复制到前缓冲（窗口）
+        // 结束双缓冲绘制 - 将后缓冲中的损坏区域一次性复制到前缓冲（窗口）
         // 这样可以避免绘制过程中的闪烁，所有绘制操作在内存中完成后一次性显示
-        cairoRenderer_->end();
+        cairoRenderer_->end(damage_);
+        frameStats_.lastPresentedBytes = cairoRenderer_->getPresentStats().lastFrameBytes;
+        notePresented();
+    }
+
+    const RenderStats &renderStats = rootContainer_->getRenderStats();
+    frameStats_.lastPaintedNodes = renderStats.paintedNodes;
+    frameStats_.lastCulledNodes = renderStats.culledNodes;
+
+    clearRegion(damage_);
+    rootContainer_->clearPaintDirty();
+    needsRender_ = false;
+}
+
+bool SWindow::collectFrameDamage()
+{
+    // 布局重新计算后任何节点都可能移动，需要遍历整棵树比较边界
+    bool laidOut = updateLayout();
+    rootContainer_->collectDamage(damage_, laidOut);
+
+    cairo_rectangle_int_t window = {0, 0, width_, height_};
+    if (needsRender_)
+    {
+        cairo_region_union_rectangle(damage_, &window);
+    }
+    cairo_region_intersect_rectangle(damage_, &window);
+    return !cairo_region_is_empty(damage_);
+}
+
+void SWindow::renderDamage(cairo_t *cr)
+{
+    cairo_save(cr);
+    int count = cairo_region_num_rectangles(damage_);
+    for (int i = 0; i < count; ++i)
+    {
+        cairo_rectangle_int_t rect;
+        cairo_region_get_rectangle(damage_, i, &rect);
+        cairo_rectangle(cr, rect.x, rect.y, rect.width, rect.height);
+    }
+    cairo_clip(cr);
+    rootContainer_->renderTree(cr, damage_);
+    cairo_restore(cr);
+}
+
+uint64_t SWindow::damageArea() const
+{
+    uint64_t area = 0;
+    int count = cairo_region_num_rectangles(damage_);
+    for (int i = 0; i < count; ++i)
+    {
+        cairo_rectangle_int_t rect;
+        cairo_region_get_rectangle(damage_, i, &rect);
+        area += static_cast<uint64_t>(rect.width) * rect.height;
+    }
+    return area;
+}
+
+bool SWindow::updateLayout()
+{
+    if (!rootContainer_ || !rootContainer_->isLayoutDirty())
+    {
+        return false;
+    }
+
+    rootContainer_->setWidth(sgui::LayoutValue::Point(width_));
+    rootContainer_->setHeight(sgui::LayoutValue::Point(height_));
+    rootContainer_->calculateLayout(width_, height_);
+    rootContainer_->clearLayoutDirty();
+    return true;
+}
+
+void SWindow::Invalidate()
+{
+    needsRender_ = true;
+}
+
+bool SWindow::NeedsRender() const
+{
+    // 有尚未分发的鼠标移动事件时也需要进入渲染流程，分发后再根据脏标记决定是否绘制
+    return needsRender_ || !pendingMotion_.empty() || (rootContainer_ && rootContainer_->isDirty());
+}
+
+void SWindow::SetTargetFrameRate(double fps)
+{
+    targetFps_ = fps > 0 ? fps : 0.0;
+    if (targetFps_ > 0)
+    {
+        frameInterval_ = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / targetFps_));
+    }
+    else
+    {
+        frameInterval_ = std::chrono::steady_clock::duration::zero();
+    }
+    // 重新对齐帧节奏
+    nextFrameTime_ = std::chrono::steady_clock::time_point{};
+}
+
+void SWindow::SetFrameRateMatchMonitor()
+{
+    if (headless_)
+    {
+        SetTargetFrameRate(60.0);
+        return;
+    }
+
+    // 全屏窗口使用其所在显示器，否则使用主显示器
+    GLFWmonitor *monitor = window_ ? glfwGetWindowMonitor(window_) : nullptr;
+    if (!monitor)
+    {
+        monitor = glfwGetPrimaryMonitor();
+    }
+
+    const GLFWvidmode *mode = monitor ? glfwGetVideoMode(monitor) : nullptr;
+    if (mode && mode->refreshRate > 0)
+    {
+        SetTargetFrameRate(mode->refreshRate);
+    }
+    else
+    {
+        SetTargetFrameRate(60.0);
+    }
+}
+
+double SWindow::GetTargetFrameRate() const
+{
+    return targetFps_;
+}
+
+FrameStats SWindow::GetFrameStats() const
+{
+    return frameStats_;
+}
+
+void SWindow::SetThreadedRendering(bool enabled)
+{
+    if (enabled && !renderThread_ && cairoRenderer_)
+    {
+        if (!headless_)
+        {
+            // 渲染线程使用自己的X连接：主线程在glfwWaitEvents中使用GLFW的连接，
+            // 没有调用XInitThreads的Xlib连接不能跨线程使用，共享连接时GLFW还会取走共享内存呈现的完成事件
+            auto renderer = std::make_unique<sgui::SCairoRenderer>(getWindowId(), width_, height_, nullptr);
+            if (!renderer->getBackSurface())
+            {
+                std::cerr << "Failed to create render thread renderer for: " << title_ << std::endl;
+                return;
+            }
+            renderer->setRasterThreads(cairoRenderer_->getRasterThreads());
+            cairoRenderer_ = std::move(renderer);
+        }
+        renderThread_ = std::make_unique<SRenderThread>(cairoRenderer_.get());
+    }
+    else if (!enabled && renderThread_)
+    {
+        // 析构时等待渲染线程退出，之后渲染器重新由主线程独占
+        renderThread_.reset();
+    }
+    needsRender_ = true;
+}
+
+bool SWindow::IsThreadedRendering() const
+{
+    return renderThread_ != nullptr;
+}
+
+void SWindow::SetRasterThreads(int threads)
+{
+    if (cairoRenderer_)
+    {
+        cairoRenderer_->setRasterThreads(threads);
+    }
+}
+
+int SWindow::GetRasterThreads() const
+{
+    return cairoRenderer_ ? cairoRenderer_->getRasterThreads() : 1;
+}
+
+void SWindow::commitFrameSnapshot()
+{
+    // 把整棵控件树记录为帧显示列表，没有变化的节点直接复用缓存的绘制记录；
+    // 快照提交后不再被主线程修改，渲染线程可以安全地回放
+    // 抗锯齿模式与渲染器后缓冲的设置一致，窗口之外的节点不记录
+    auto displayList = std::make_shared<SDisplayList>();
+    rootContainer_->recordDisplayList(*displayList, CAIRO_ANTIALIAS_SUBPIXEL, Rect(0, 0, width_, height_));
+
+    FrameSnapshot snapshot;
+    snapshot.displayList = displayList;
+    snapshot.width = width_;
+    snapshot.height = height_;
+    renderThread_->commit(std::move(snapshot));
+}
+
+bool SWindow::isFrameDue(std::chrono::steady_clock::time_point now) const
+{
+    return targetFps_ <= 0 || now >= nextFrameTime_;
+}
+
+void SWindow::renderScheduledFrame(std::chrono::steady_clock::time_point now, bool continuous)
+{
+    auto scheduled = nextFrameTime_;
+    if (targetFps_ <= 0 || scheduled == std::chrono::steady_clock::time_point{})
+    {
+        scheduled = now;
+    }
+    else if (now - scheduled >= frameInterval_)
+    {
+        // 追帧规则：落后一个帧间隔以上时，中间的帧已经过时，直接丢弃而不是排队补渲染
+        auto behind = (now - scheduled) / frameInterval_;
+        // 上一帧渲染超时或者连续模式下窗口一直在请求帧，才算真正丢帧；
+        // 否则只是窗口空闲了一段时间，重新对齐节奏即可
+        if (continuous || frameStats_.lastFrameEnd > scheduled)
+        {
+            frameStats_.droppedFrames += behind;
+        }
+        scheduled += behind * frameInterval_;
+    }
+
+    frameStats_.lastFrameStart = now;
+    Render();
+    auto end = manager_ ? manager_->Now() : std::chrono::steady_clock::now();
+    frameStats_.lastFrameEnd = end;
+    frameStats_.frameCount++;
+
+    if (targetFps_ > 0)
+    {
+        // 每一帧必须在下一个时间槽开始前完成
+        auto deadline = scheduled + frameInterval_;
+        if (end > deadline)
+        {
+            frameStats_.missedDeadlines++;
+        }
+        nextFrameTime_ = deadline;
     }
 }
 
 bool SWindow::ShouldClose() const
 {
+    if (headless_)
+    {
+        return closeRequested_;
+    }
     return window_ ? glfwWindowShouldClose(window_) : true;
 }
 
+void SWindow::Close()
+{
+    closeRequested_ = true;
+    if (window_)
+    {
+        glfwSetWindowShouldClose(window_, GLFW_TRUE);
+    }
+}
+
+bool SWindow::IsHeadless() const
+{
+    return headless_;
+}
+
+cairo_surface_t *SWindow::GetFrameSurface() const
+{
+    return cairoRenderer_ ? cairoRenderer_->getBackSurface() : nullptr;
+}
+
+SDisplayListPtr SWindow::CaptureDisplayList()
+{
+    if (!rootContainer_)
+    {
+        return nullptr;
+    }
+
+    // 使用最近一次计算的布局，布局由Render统一更新，以便正确收集损坏区域
+    auto displayList = std::make_shared<SDisplayList>();
+    rootContainer_->recordDisplayList(*displayList, CAIRO_ANTIALIAS_SUBPIXEL);
+    return displayList;
+}
+
+bool SWindow::SaveFrame(const std::string &path)
+{
+    if (!cairoRenderer_)
+    {
+        return false;
+    }
+
+    // 等待渲染线程处理完已提交的快照
+    if (renderThread_)
+    {
+        renderThread_->waitIdle();
+    }
+
+    bool ppm = path.size() >= 4 && path.compare(path.size() - 4, 4, ".ppm") == 0;
+    return ppm ? cairoRenderer_->writeToPpm(path) : cairoRenderer_->writeToPng(path);
+}
+
 void *SWindow::GetWindow() const
 {
     return window_;
@@ -132,6 +485,7 @@ void SWindow::SetRootContainer(std::shared_ptr<sgui::SContainer> root)
 {
     rootContainer_ = root;
     rootContainer_->markDirty();
+    needsRender_ = true;
 }
 
 std::shared_ptr<sgui::SContainer> SWindow::GetRootContainer() const
@@ -167,19 +521,7 @@ void SWindow::WindowSizeCallback(GLFWwindow *window, int width, int height)
     auto win = static_cast<SWindow *>(glfwGetWindowUserPointer(window));
     if (win)
     {
-        win->width_ = width;
-        win->height_ = height;
-
-        // 调整简化的Cairo渲染器大小
-        if (win->cairoRenderer_)
-        {
-            win->cairoRenderer_->resize(width, height);
-        }
-        if (win->rootContainer_ != nullptr)
-        {
-            win->rootContainer_->markDirty();
-        }
-        std::cout << "Window resized: " << win->title_ << " -> " << width << "x" << height << std::endl;
+        win->handleResize(width, height);
     }
 }
 
@@ -194,6 +536,50 @@ void SWindow::WindowCloseCallback(GLFWwindow *window)
     }
 }
 
+// 窗口刷新回调（窗口被遮挡后重新显示等情况）
+void SWindow::WindowRefreshCallback(GLFWwindow *window)
+{
+    auto win = static_cast<SWindow *>(glfwGetWindowUserPointer(window));
+    if (win)
+    {
+        win->Invalidate();
+    }
+}
+
+void SWindow::applyPendingResize()
+{
+    if (!resizePending_)
+    {
+        return;
+    }
+    resizePending_ = false;
+
+    // 调整简化的Cairo渲染器大小（渲染线程运行时需要与其同步）
+    if (renderThread_)
+    {
+        renderThread_->resizeRenderer(width_, height_);
+    }
+    else if (cairoRenderer_)
+    {
+        cairoRenderer_->resize(width_, height_);
+    }
+}
+
+void SWindow::handleResize(int width, int height)
+{
+    width_ = width;
+    height_ = height;
+
+    // 拖动窗口边框时一帧内会收到很多次尺寸变化，渲染器只在下一帧开始时按最终尺寸调整一次
+    resizePending_ = true;
+    if (rootContainer_ != nullptr)
+    {
+        rootContainer_->markDirty();
+    }
+    needsRender_ = true;
+    std::cout << "Window resized: " << title_ << " -> " << width << "x" << height << std::endl;
+}
+
 // 全局状态记录，用于跟踪鼠标当前所在的控件（最深层）
 static sgui::SContainer *g_lastMouseInsideContainer = nullptr;
 
@@ -241,8 +627,12 @@ static sgui::SContainer *findDeepestContainerAtPosition(sgui::SContainer *contai
     return container;
 }
 
+// 每帧最多保留的鼠标移动历史，超过后丢弃较早的一半
+static const size_t kMaxMotionHistory = 256;
+
 // 辅助函数：将鼠标事件分发到控件树
-static void dispatchMouseEvent(sgui::SContainer *rootContainer, const MouseEvent &event)
+// history为本帧合并的鼠标移动事件（窗口坐标），仅用于移动事件
+static void dispatchMouseEvent(sgui::SContainer *rootContainer, const MouseEvent &event, const std::vector<MouseEvent> *history = nullptr)
 {
     if (!rootContainer)
         return;
@@ -287,7 +677,25 @@ static void dispatchMouseEvent(sgui::SContainer *rootContainer, const MouseEvent
         MouseEvent moveEvent = event;
         moveEvent.x = subx;
         moveEvent.y = suby;
-        targetContainer->onMouseMoved(moveEvent);
+
+        // 历史事件转换到与最新事件相同的控件坐标系
+        std::vector<MouseEvent> relativeHistory;
+        if (history)
+        {
+            relativeHistory.reserve(history->size());
+            for (const auto &e : *history)
+            {
+                MouseEvent relative = e;
+                relative.x = e.x - (event.x - subx);
+                relative.y = e.y - (event.y - suby);
+                relativeHistory.push_back(relative);
+            }
+        }
+        else
+        {
+            relativeHistory.push_back(moveEvent);
+        }
+        targetContainer->onMouseMovedCoalesced(moveEvent, relativeHistory);
     }
 
     // 处理其他事件类型（只在目标容器上处理）
@@ -355,14 +763,9 @@ static void dispatchKeyEvent(SContainer *container, const KeyEvent &event)
 void SWindow::MousePosCallback(GLFWwindow *window, double xpos, double ypos)
 {
     auto win = static_cast<SWindow *>(glfwGetWindowUserPointer(window));
-    if (win && win->rootContainer_)
+    if (win)
     {
-        MouseEvent event;
-        event.x = xpos;
-        event.y = ypos;
-        event.type = MouseEventType::Moving;
-
-        dispatchMouseEvent(win->rootContainer_.get(), event);
+        win->handleCursorPos(xpos, ypos);
     }
 }
 
@@ -370,27 +773,11 @@ void SWindow::MousePosCallback(GLFWwindow *window, double xpos, double ypos)
 void SWindow::MouseButtonCallback(GLFWwindow *window, int button, int action, int mods)
 {
     auto win = static_cast<SWindow *>(glfwGetWindowUserPointer(window));
-    if (win && win->rootContainer_)
+    if (win)
     {
         // 获取当前鼠标位置
-        double xpos, ypos;
-        glfwGetCursorPos(window, &xpos, &ypos);
-
-        MouseEvent event;
-        event.x = xpos;
-        event.y = ypos;
-        event.button = static_cast<MouseButton>(button);
-
-        if (action == GLFW_PRESS)
-        {
-            event.type = MouseEventType::Pressed;
-        }
-        else if (action == GLFW_RELEASE)
-        {
-            event.type = MouseEventType::Released | MouseEventType::Clicked; // 简化处理：释放时视为点击
-        }
-
-        dispatchMouseEvent(win->rootContainer_.get(), event);
+        glfwGetCursorPos(window, &win->cursorX_, &win->cursorY_);
+        win->handleMouseButton(button, action, mods);
     }
 }
 
@@ -398,15 +785,11 @@ void SWindow::MouseButtonCallback(GLFWwindow *window, int button, int action, in
 void SWindow::ScrollCallback(GLFWwindow *window, double xoffset, double yoffset)
 {
     auto win = static_cast<SWindow *>(glfwGetWindowUserPointer(window));
-    if (win && win->rootContainer_)
+    if (win)
     {
         // 获取当前鼠标位置
-        double xpos, ypos;
-        glfwGetCursorPos(window, &xpos, &ypos);
-
-        MouseEvent event(xpos, ypos, static_cast<float>(xoffset), static_cast<float>(yoffset));
-
-        dispatchMouseEvent(win->rootContainer_.get(), event);
+        glfwGetCursorPos(window, &win->cursorX_, &win->cursorY_);
+        win->handleScroll(xoffset, yoffset);
     }
 }
 
@@ -414,24 +797,9 @@ void SWindow::ScrollCallback(GLFWwindow *window, double xoffset, double yoffset)
 void SWindow::KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mods)
 {
     auto win = static_cast<SWindow *>(glfwGetWindowUserPointer(window));
-    if (win && win->rootContainer_)
+    if (win)
     {
-        KeyEventType type = KeyEventType::Null;
-        if (action == GLFW_PRESS)
-        {
-            type = KeyEventType::Pressed;
-        }
-        else if (action == GLFW_RELEASE)
-        {
-            type = KeyEventType::Released;
-        }
-        else if (action == GLFW_REPEAT)
-        {
-            type = KeyEventType::Repeat;
-        }
-
-        KeyEvent event(key, type, mods);
-        dispatchKeyEvent(win->rootContainer_.get(), event);
+        win->handleKey(key, action, mods);
     }
 }
 
@@ -439,50 +807,351 @@ void SWindow::KeyCallback(GLFWwindow *window, int key, int scancode, int action,
 void SWindow::CharCallback(GLFWwindow *window, unsigned int codepoint)
 {
     auto win = static_cast<SWindow *>(glfwGetWindowUserPointer(window));
-    if (win && win->rootContainer_)
+    if (win)
     {
-        KeyEvent event(codepoint);
-        dispatchKeyEvent(win->rootContainer_.get(), event);
+        win->handleChar(codepoint);
     }
 }
 
-// WindowManager类的实现
-
-SWindowManager::SWindowManager() : glfw_initialized_(false)
+void SWindow::handleCursorPos(double xpos, double ypos)
 {
+    cursorX_ = xpos;
+    cursorY_ = ypos;
+    if (!rootContainer_)
+        return;
+
+    noteInput();
+
+    MouseEvent event;
+    event.x = xpos;
+    event.y = ypos;
+    event.type = MouseEventType::Moving;
+
+    // 只记录事件，由帧调度器在渲染前合并分发
+    if (pendingMotion_.size() >= kMaxMotionHistory)
+    {
+        pendingMotion_.erase(pendingMotion_.begin(), pendingMotion_.begin() + kMaxMotionHistory / 2);
+    }
+    pendingMotion_.push_back(event);
 }
 
-SWindowManager::~SWindowManager()
+void SWindow::flushMouseMotion()
 {
-    // 清理所有窗口
-    windows_.clear();
-    if (glfw_initialized_)
+    if (pendingMotion_.empty() || !rootContainer_)
     {
-        glfwTerminate();
+        pendingMotion_.clear();
+        return;
     }
+
+    // 只对最后的位置做一次命中测试和分发，完整轨迹通过history传给控件
+    std::vector<MouseEvent> history;
+    history.swap(pendingMotion_);
+    dispatchMouseEvent(rootContainer_.get(), history.back(), &history);
 }
 
-// 创建新窗口
-std::shared_ptr<SWindow> SWindowManager::CreateWindow(int width, int height, const char *title)
+void SWindow::handleMouseButton(int button, int action, int mods)
 {
-    // 初始化GLFW（如果还没有初始化）
-    if (!glfw_initialized_)
+    if (!rootContainer_)
+        return;
+
+    MouseEvent event;
+    event.x = cursorX_;
+    event.y = cursorY_;
+    event.button = static_cast<MouseButton>(button);
+
+    if (action == GLFW_PRESS)
     {
-        if (!glfwInit())
-        {
-            std::cerr << "Failed to initialize GLFW" << std::endl;
-            return nullptr;
-        }
-        glfw_initialized_ = true;
+        event.type = MouseEventType::Pressed;
     }
-
-    auto window = std::make_shared<SWindow>(width, height, title, this);
-    if (window->Initialize())
+    else if (action == GLFW_RELEASE)
     {
-        windows_.push_back(window);
-        return window;
+        event.type = MouseEventType::Released | MouseEventType::Clicked; // 简化处理：释放时视为点击
     }
-    return nullptr;
+
+    noteInput();
+    flushMouseMotion();
+    dispatchMouseEvent(rootContainer_.get(), event);
+    presentInputImmediately(g_lastMouseInsideContainer);
+}
+
+void SWindow::handleScroll(double xoffset, double yoffset)
+{
+    if (!rootContainer_)
+        return;
+
+    MouseEvent event(cursorX_, cursorY_, static_cast<float>(xoffset), static_cast<float>(yoffset));
+
+    noteInput();
+    flushMouseMotion();
+    dispatchMouseEvent(rootContainer_.get(), event);
+    presentInputImmediately(g_lastMouseInsideContainer);
+}
+
+void SWindow::handleKey(int key, int action, int mods)
+{
+    if (!rootContainer_)
+        return;
+
+    KeyEventType type = KeyEventType::Null;
+    if (action == GLFW_PRESS)
+    {
+        type = KeyEventType::Pressed;
+    }
+    else if (action == GLFW_RELEASE)
+    {
+        type = KeyEventType::Released;
+    }
+    else if (action == GLFW_REPEAT)
+    {
+        type = KeyEventType::Repeat;
+    }
+
+    KeyEvent event(key, type, mods);
+    noteInput();
+    flushMouseMotion();
+    dispatchKeyEvent(rootContainer_.get(), event);
+    presentInputImmediately(g_lastMouseInsideContainer);
+}
+
+void SWindow::handleChar(unsigned int codepoint)
+{
+    if (!rootContainer_)
+        return;
+
+    KeyEvent event(codepoint);
+    noteInput();
+    flushMouseMotion();
+    dispatchKeyEvent(rootContainer_.get(), event);
+    presentInputImmediately(g_lastMouseInsideContainer);
+}
+
+void SWindow::noteInput()
+{
+    if (!hasPendingInput_)
+    {
+        hasPendingInput_ = true;
+        pendingInputTime_ = manager_ ? manager_->Now() : std::chrono::steady_clock::now();
+    }
+}
+
+void SWindow::notePresented()
+{
+    if (!hasPendingInput_)
+    {
+        return;
+    }
+    auto now = manager_ ? manager_->Now() : std::chrono::steady_clock::now();
+    inputLatency_.record(now - pendingInputTime_);
+    hasPendingInput_ = false;
+}
+
+void SWindow::presentInputImmediately(SContainer *target)
+{
+    if (!lowLatency_ || !target || !rootContainer_ || !cairoRenderer_ || renderThread_ || ShouldClose())
+    {
+        return;
+    }
+
+    // 全局记录的控件可能属于其他窗口
+    if (target->getRoot() != rootContainer_.get())
+    {
+        return;
+    }
+
+    // 输入没有改变任何控件时不需要重绘
+    if (!rootContainer_->isDirty())
+    {
+        return;
+    }
+
+    // 收集输入造成的损坏区域；窗口整体失效或区域过大时留给正常的帧渲染
+    if (needsRender_ || !collectFrameDamage())
+    {
+        return;
+    }
+    uint64_t area = damageArea();
+    if (static_cast<double>(area) > lowLatencyMaxArea_)
+    {
+        // 已收集的区域保留在damage_中，由下一帧一起重绘
+        return;
+    }
+
+    // 只重绘并呈现损坏区域；重绘后控件树和后缓冲一致，相当于完成了一帧
+    cairoRenderer_->begin();
+    cairo_t *cr = cairoRenderer_->getContext();
+    if (cr)
+    {
+        renderDamage(cr);
+    }
+    cairoRenderer_->end(damage_);
+    notePresented();
+
+    frameStats_.lastDamageArea = area;
+    frameStats_.lastPresentedBytes = cairoRenderer_->getPresentStats().lastFrameBytes;
+    clearRegion(damage_);
+    rootContainer_->clearPaintDirty();
+}
+
+void SWindow::SetLowLatencyMode(bool enabled, double maxArea)
+{
+    lowLatency_ = enabled;
+    lowLatencyMaxArea_ = maxArea;
+}
+
+const LatencyHistogram &SWindow::GetInputLatencyHistogram() const
+{
+    return inputLatency_;
+}
+
+void SWindow::ResetInputLatencyHistogram()
+{
+    inputLatency_ = LatencyHistogram();
+}
+
+void LatencyHistogram::record(std::chrono::steady_clock::duration latency)
+{
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    uint64_t value = us > 0 ? static_cast<uint64_t>(us) : 0;
+
+    size_t bucket = 0;
+    while (bucket + 1 < kBucketCount && (value >> (bucket + 1)) != 0)
+    {
+        bucket++;
+    }
+
+    buckets[bucket]++;
+    count++;
+    totalUs += value;
+    maxUs = std::max(maxUs, value);
+}
+
+double LatencyHistogram::percentileUs(double p) const
+{
+    if (count == 0)
+    {
+        return 0.0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::min(100.0, std::max(0.0, p)) / 100.0 * count));
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+        {
+            // 桶的上界，不超过实际最大值
+            return std::min(static_cast<double>(1ULL << (i + 1)), static_cast<double>(maxUs));
+        }
+    }
+    return static_cast<double>(maxUs);
+}
+
+// 注入输入事件：与平台回调走相同的处理路径
+
+void SWindow::InjectMouseMove(double x, double y)
+{
+    handleCursorPos(x, y);
+}
+
+void SWindow::InjectMouseButton(MouseButton button, bool pressed, int mods)
+{
+    handleMouseButton(static_cast<int>(button), pressed ? GLFW_PRESS : GLFW_RELEASE, mods);
+}
+
+void SWindow::InjectScroll(double xoffset, double yoffset)
+{
+    handleScroll(xoffset, yoffset);
+}
+
+void SWindow::InjectKey(int key, KeyEventType type, int mods)
+{
+    int action = GLFW_PRESS;
+    if (type == KeyEventType::Released)
+    {
+        action = GLFW_RELEASE;
+    }
+    else if (type == KeyEventType::Repeat)
+    {
+        action = GLFW_REPEAT;
+    }
+    handleKey(key, action, mods);
+}
+
+void SWindow::InjectChar(unsigned int codepoint)
+{
+    handleChar(codepoint);
+}
+
+void SWindow::InjectResize(int width, int height)
+{
+    if (window_)
+    {
+        // 有真实窗口时由窗口系统回调handleResize
+        glfwSetWindowSize(window_, width, height);
+        return;
+    }
+    handleResize(width, height);
+}
+
+// WindowManager类的实现
+
+SWindowManager::SWindowManager(WindowBackend backend)
+    : glfw_initialized_(false), backend_(backend), virtualNow_(std::chrono::steady_clock::now()), taskQueue_(std::make_unique<STaskQueue>()), timers_(std::make_unique<STimerService>([this]() { return Now(); }))
+{
+    g_windowManagers.push_back(this);
+    installGlobals();
+}
+
+SWindowManager::~SWindowManager()
+{
+    // 全局状态交还给仍然存在的最后一个管理器，没有时清除
+    bool wasCurrent = !g_windowManagers.empty() && g_windowManagers.back() == this;
+    g_windowManagers.erase(std::remove(g_windowManagers.begin(), g_windowManagers.end(), this), g_windowManagers.end());
+    if (wasCurrent)
+    {
+        if (g_windowManagers.empty())
+        {
+            STimerService::setCurrent(nullptr);
+            SThreadPool::setCompletionDispatcher(nullptr);
+        }
+        else
+        {
+            g_windowManagers.back()->installGlobals();
+        }
+    }
+
+    // 清理所有窗口
+    windows_.clear();
+    timers_.reset();
+    if (glfw_initialized_)
+    {
+        glfwTerminate();
+    }
+}
+
+// 创建新窗口
+std::shared_ptr<SWindow> SWindowManager::CreateWindow(int width, int height, const char *title)
+{
+    // 初始化GLFW（如果还没有初始化，无窗口模式不需要）
+    if (!IsHeadless() && !glfw_initialized_)
+    {
+        if (!glfwInit())
+        {
+            std::cerr << "Failed to initialize GLFW" << std::endl;
+            return nullptr;
+        }
+        glfw_initialized_ = true;
+    }
+
+    auto window = std::make_shared<SWindow>(width, height, title, this);
+    if (window->Initialize())
+    {
+        windows_.push_back(window);
+        return window;
+    }
+    return nullptr;
 }
 
 // 移除关闭的窗口
@@ -515,38 +1184,399 @@ void SWindowManager::Run()
     std::cout << "Created " << windows_.size() << " windows with simplified Cairo rendering." << std::endl;
     std::cout << "Each window can be closed independently. Program exits when all windows are closed." << std::endl;
 
-    // // 使用高精度时钟实现帧率控制
-    // const auto target_frame_duration = std::chrono::nanoseconds(16666667); // 60 FPS = 16.666667ms
-    // auto next_frame_time = std::chrono::high_resolution_clock::now();
+    statsPeriodStart_ = Now();
 
     while (!windows_.empty())
     {
-        // 渲染所有打开的窗口
-        for (auto &window : windows_)
+        RunFrame();
+        if (windows_.empty())
         {
-            window->Render();
+            break;
         }
 
-        // 移除关闭的窗口
-        RemoveClosedWindows();
-
         // 处理事件
+        double timeout = computeWaitTimeout();
+        if (IsHeadless() && isHeadlessIdle(timeout))
+        {
+            // 后台任务（例如图片解码）还没有完成时，它们的完成回调还会投递到任务队列。
+            // 按真实时间短暂等待后继续迭代，不推进虚拟时钟；不无限等待，任务可能正在等待UI线程执行Invoke
+            SThreadPool *pool = SThreadPool::existingInstance();
+            if (pool && !pool->isIdle())
+            {
+                pool->waitIdleFor(std::chrono::milliseconds(10));
+                continue;
+            }
+            // 线程池在计算超时之后才变为空闲时，最后的完成回调可能刚刚投递
+            if (!taskQueue_->empty())
+            {
+                continue;
+            }
+
+            // 无窗口模式下没有外部事件源，已经没有待处理的工作
+            std::cout << "Headless loop is idle. Exiting." << std::endl;
+            return;
+        }
+        waitForEvents(timeout);
+        recordWakeup();
+    }
+
+    std::cout << "All windows closed. Exiting program." << std::endl;
+}
+
+void SWindowManager::RunFrame()
+{
+    // 先执行其他线程投递的任务，任务造成的修改在本次迭代统一布局和重绘
+    drainTasks();
+    runTimers();
+
+    // 渲染窗口：连续模式下所有窗口持续请求帧，事件驱动模式下只有失效的窗口请求帧
+    // 帧调度器只渲染已经到达计划时间点的窗口，保证各窗口按自己的帧率稳定渲染
+    bool continuous = isContinuous();
+    for (auto &window : windows_)
+    {
+        if (!continuous && !window->NeedsRender())
+        {
+            stats_.framesSkipped++;
+            continue;
+        }
+
+        auto now = Now();
+        if (!window->isFrameDue(now))
+        {
+            continue;
+        }
+        window->flushMouseMotion();
+        window->renderScheduledFrame(now, continuous);
+        stats_.framesRendered++;
+    }
+
+    // 移除关闭的窗口
+    RemoveClosedWindows();
+
+    // 利用到下一帧之前的空闲时间执行低优先级工作
+    runIdleCallbacks();
+}
+
+bool SWindowManager::isHeadlessIdle(double timeout) const
+{
+    if (timeout < 0)
+    {
+        return true;
+    }
+
+    // 只剩下重复定时器（例如获得焦点的输入框的光标闪烁）时，虚拟时钟会无限推进下去，视为空闲
+    if (timers_->hasOneShotTimers() || timers_->hasAnimationFrameRequests() || !taskQueue_->empty() ||
+        !idleCallbacks_.empty())
+    {
+        return false;
+    }
+    return std::none_of(windows_.begin(), windows_.end(),
+                        [](const std::shared_ptr<SWindow> &window) { return window->NeedsRender(); });
+}
+
+double SWindowManager::computeWaitTimeout() const
+{
+    bool continuous = isContinuous();
+    auto now = Now();
+
+    // 连续模式下未限制帧率的窗口保持原来1ms的轮询间隔
+    double timeout = -1.0;
+    if (!taskQueue_->empty())
+    {
+        // 还有任务（例如任务中再次投递的任务）等待执行，不阻塞
+        return 0.0;
+    }
+
+    // 最近的定时器到期时间
+    std::chrono::steady_clock::time_point deadline;
+    if (timers_->nextDeadline(deadline))
+    {
+        timeout = std::max(0.0, std::chrono::duration<double>(deadline - now).count());
+    }
+
+    // 有动画帧回调时所有窗口都需要在下一帧时间点醒来
+    bool animating = timers_->hasAnimationFrameRequests();
+    for (const auto &window : windows_)
+    {
+        if (!continuous && !animating && !window->NeedsRender())
+        {
+            continue;
+        }
+
+        double windowTimeout = continuous ? 0.001 : 0.0;
+        if (window->targetFps_ > 0)
+        {
+            windowTimeout = std::max(0.0, std::chrono::duration<double>(window->nextFrameTime_ - now).count());
+        }
+
+        if (timeout < 0 || windowTimeout < timeout)
+        {
+            timeout = windowTimeout;
+        }
+    }
+
+    // 空闲回调：有超时的在超时时间点醒来，其余的在没有其他工作时立即开始下一个空闲时段
+    if (!idleCallbacks_.empty())
+    {
+        double idleTimeout = -1.0;
+        for (const auto &entry : idleCallbacks_)
+        {
+            if (entry.second.hasTimeout)
+            {
+                double t = std::max(0.0, std::chrono::duration<double>(entry.second.timeoutAt - now).count());
+                idleTimeout = idleTimeout < 0 ? t : std::min(idleTimeout, t);
+            }
+        }
+        if (timeout < 0)
+        {
+            timeout = 0.0;
+        }
+        else if (idleTimeout >= 0)
+        {
+            timeout = std::min(timeout, idleTimeout);
+        }
+    }
+    return timeout;
+}
+
+void SWindowManager::runTimers()
+{
+    size_t fired = timers_->advance();
+
+    // 动画帧回调在有窗口到达帧时间点时执行，执行后所有窗口都会在本次迭代重绘
+    size_t frames = 0;
+    if (timers_->hasAnimationFrameRequests())
+    {
+        auto now = Now();
+        bool frameDue = std::any_of(windows_.begin(), windows_.end(), [now](const std::shared_ptr<SWindow> &window) { return window->isFrameDue(now); });
+        if (frameDue)
+        {
+            frames = timers_->runAnimationFrames(now);
+        }
+    }
+
+    stats_.timersFired += fired;
+    stats_.animationFrames += frames;
+}
+
+uint64_t SWindowManager::RequestIdleCallback(IdleCallback callback, uint32_t timeoutMs)
+{
+    uint64_t id = nextIdleId_++;
+    IdleRequest request;
+    request.callback = std::move(callback);
+    if (timeoutMs > 0)
+    {
+        request.hasTimeout = true;
+        request.timeoutAt = Now() + std::chrono::milliseconds(timeoutMs);
+    }
+    idleCallbacks_.emplace(id, std::move(request));
+    return id;
+}
+
+void SWindowManager::CancelIdleCallback(uint64_t id)
+{
+    idleCallbacks_.erase(id);
+}
+
+// 未限制帧率的窗口按60Hz的名义帧预算计算空闲时间，帧本身超出预算时至少留出1ms，
+// 否则连续模式下空闲时段总是为空，没有超时的空闲回调永远不会执行
+static const std::chrono::steady_clock::duration kNominalFrameBudget =
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / 60.0));
+static const std::chrono::steady_clock::duration kMinIdleSlice = std::chrono::milliseconds(1);
+
+std::chrono::steady_clock::time_point SWindowManager::computeIdleDeadline(std::chrono::steady_clock::time_point now) const
+{
+    // 没有帧需要渲染时，空闲时段最长50ms，保证新的输入能及时得到响应
+    auto deadline = now + std::chrono::milliseconds(50);
+
+    if (!taskQueue_->empty())
+    {
+        return now;
+    }
+
+    std::chrono::steady_clock::time_point timerDeadline;
+    if (timers_->nextDeadline(timerDeadline))
+    {
+        deadline = std::min(deadline, timerDeadline);
+    }
+
+    bool continuous = isContinuous();
+    bool animating = timers_->hasAnimationFrameRequests();
+    for (const auto &window : windows_)
+    {
+        if (!continuous && !animating && !window->NeedsRender())
+        {
+            continue;
+        }
+
+        // 未限制帧率的窗口马上就要渲染下一帧，只使用名义帧预算中剩余的时间
+        auto frameTime = window->targetFps_ > 0
+                             ? window->nextFrameTime_
+                             : std::max(window->frameStats_.lastFrameStart + kNominalFrameBudget, now + kMinIdleSlice);
+        deadline = std::min(deadline, frameTime);
+    }
+    return deadline;
+}
+
+void SWindowManager::runIdleCallbacks()
+{
+    if (idleCallbacks_.empty())
+    {
+        return;
+    }
+
+    auto deadline = computeIdleDeadline(Now());
+
+    // 只执行本时段开始前请求的回调
+    uint64_t lastId = nextIdleId_ - 1;
+    auto it = idleCallbacks_.begin();
+    while (it != idleCallbacks_.end() && it->first <= lastId)
+    {
+        auto now = Now();
+        bool timedOut = it->second.hasTimeout && now >= it->second.timeoutAt;
+        if (now >= deadline && !timedOut)
+        {
+            ++it;
+            continue;
+        }
+
+        uint64_t id = it->first;
+        IdleCallback callback = std::move(it->second.callback);
+        idleCallbacks_.erase(it);
+
+        callback(IdleDeadline(this, deadline, timedOut));
+        stats_.idleCallbacks++;
+
+        // 回调可能增删了其他回调，从下一个ID继续
+        it = idleCallbacks_.upper_bound(id);
+    }
+}
+
+double IdleDeadline::timeRemaining() const
+{
+    auto now = manager_ ? manager_->Now() : std::chrono::steady_clock::now();
+    return std::max(0.0, std::chrono::duration<double, std::milli>(deadline_ - now).count());
+}
+
+void SWindowManager::waitForEvents(double timeout)
+{
+    if (IsHeadless())
+    {
+        // 无窗口模式下等待即推进虚拟时钟
+        if (timeout > 0)
+        {
+            AdvanceTime(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timeout)));
+        }
+        return;
+    }
+
+    if (timeout < 0)
+    {
+        // 阻塞直到有窗口事件或者glfwPostEmptyEvent唤醒
+        glfwWaitEvents();
+    }
+    else if (timeout == 0)
+    {
         glfwPollEvents();
+    }
+    else
+    {
+        // 等待到最近一个窗口的下一帧时间点，期间有事件会提前返回
+        glfwWaitEventsTimeout(timeout);
+    }
+}
+
+void SWindowManager::recordWakeup()
+{
+    stats_.totalWakeups++;
+    wakeupsInPeriod_++;
+
+    auto now = Now();
+    auto elapsed = std::chrono::duration<double>(now - statsPeriodStart_).count();
+    if (elapsed >= 1.0)
+    {
+        stats_.wakeupsPerSecond = wakeupsInPeriod_ / elapsed;
+        wakeupsInPeriod_ = 0;
+        statsPeriodStart_ = now;
+    }
+}
 
-        // // 计算下一帧时间点
-        // next_frame_time += target_frame_duration;
+void SWindowManager::SetLoopMode(LoopMode mode)
+{
+    loopMode_ = mode;
+}
 
-        // // 等待到下一帧时间点
-        // auto now = std::chrono::high_resolution_clock::now();
-        // if (next_frame_time > now)
-        // {
-        //     std::this_thread::sleep_until(next_frame_time);
-        // }
+LoopMode SWindowManager::GetLoopMode() const
+{
+    return loopMode_;
+}
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+void SWindowManager::installGlobals()
+{
+    STimerService::setCurrent(timers_.get());
+
+    // 线程池任务的完成回调投递到UI线程执行
+    SThreadPool::setCompletionDispatcher([this](std::function<void()> completion) { Post(std::move(completion)); });
+}
+
+bool SWindowManager::isContinuous() const
+{
+    // 无窗口模式没有外部事件，连续轮询只会让Run()永远不返回，总是按事件驱动模式运行
+    return loopMode_ == LoopMode::Continuous && !IsHeadless();
+}
+
+void SWindowManager::Wakeup()
+{
+    if (glfw_initialized_)
+    {
+        glfwPostEmptyEvent();
     }
+}
 
-    std::cout << "All windows closed. Exiting program." << std::endl;
+LoopStats SWindowManager::GetLoopStats() const
+{
+    return stats_;
+}
+
+void SWindowManager::Post(std::function<void()> task)
+{
+    // 只有自上次执行任务以来的第一次投递才需要唤醒主循环
+    if (taskQueue_->push(std::move(task)))
+    {
+        Wakeup();
+    }
+}
+
+void SWindowManager::drainTasks()
+{
+    stats_.tasksExecuted += taskQueue_->drain();
+}
+
+bool SWindowManager::IsHeadless() const
+{
+    return backend_ == WindowBackend::Headless;
+}
+
+std::chrono::steady_clock::time_point SWindowManager::Now() const
+{
+    if (IsHeadless())
+    {
+        return virtualNow_;
+    }
+    return std::chrono::steady_clock::now();
+}
+
+void SWindowManager::AdvanceTime(std::chrono::steady_clock::duration delta)
+{
+    if (delta > std::chrono::steady_clock::duration::zero())
+    {
+        virtualNow_ += delta;
+    }
+}
+
+STimerService &SWindowManager::GetTimerService()
+{
+    return *timers_;
 }
 
 // 获取窗口数量
@@ -0,0 +1,51 @@
+/**
+ * 回归测试的检查宏
+ *
+ * 检查失败时打印位置并继续执行，测试结束时由finish()返回进程退出码
+ */
+
+#pragma once
+
+#include <cstdio>
+
+namespace sgui_test {
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+/**
+ * 打印测试结果
+ * @return 全部检查通过时返回0
+ */
+inline int finish(const char* name) {
+    if (failures() > 0) {
+        std::fprintf(stderr, "%s: %d check(s) failed\n", name, failures());
+        return 1;
+    }
+    std::printf("%s: passed\n", name);
+    return 0;
+}
+
+} // namespace sgui_test
+
+#define SGUI_CHECK(cond)                                                                \
+    do {                                                                                \
+        if (!(cond)) {                                                                  \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            sgui_test::failures()++;                                                    \
+        }                                                                               \
+    } while (0)
+
+#define SGUI_CHECK_EQ(actual, expected)                                                            \
+    do {                                                                                           \
+        auto sguiActual_ = (actual);                                                               \
+        auto sguiExpected_ = (expected);                                                           \
+        if (!(sguiActual_ == sguiExpected_)) {                                                     \
+            std::fprintf(stderr, "%s:%d: check failed: %s == %s (got %lld, expected %lld)\n",       \
+                         __FILE__, __LINE__, #actual, #expected, static_cast<long long>(sguiActual_), \
+                         static_cast<long long>(sguiExpected_));                                   \
+            sgui_test::failures()++;                                                               \
+        }                                                                                          \
+    } while (0)
@@ -0,0 +1,132 @@
+/**
+ * A8模糊测试
+ *
+ * 在奇数宽度、带行尾填充的随机A8图像上，用当前CPU支持的每个向量化实现做高斯模糊，
+ * 与标量实现逐字节比较；行尾填充字节不能被修改
+ */
+
+#include "internal/sgui_blur.h"
+#include "sgui_test.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace sgui;
+
+namespace {
+
+const unsigned char kPadding = 0xa5;
+
+struct Image {
+    int width;
+    int height;
+    int stride;
+    std::vector<unsigned char> data;
+};
+
+Image randomImage(std::mt19937& random, int width, int height, int padding) {
+    Image image;
+    image.width = width;
+    image.height = height;
+    // cairo的A8行距按4字节对齐，额外的填充模拟更大的行距
+    image.stride = ((width + 3) & ~3) + padding;
+    image.data.assign(static_cast<size_t>(image.stride) * height, kPadding);
+
+    std::uniform_int_distribution<int> value(0, 255);
+    std::bernoulli_distribution solid(0.3);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            // 混合纯色块和噪声，覆盖0和255的边界值
+            int v = value(random);
+            image.data[static_cast<size_t>(y) * image.stride + x] = solid(random) ? (v < 128 ? 0 : 255) : v;
+        }
+    }
+    return image;
+}
+
+bool paddingIntact(const Image& image) {
+    for (int y = 0; y < image.height; ++y) {
+        for (int x = image.width; x < image.stride; ++x) {
+            if (image.data[static_cast<size_t>(y) * image.stride + x] != kPadding) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool sameContent(const Image& a, const Image& b) {
+    for (int y = 0; y < a.height; ++y) {
+        size_t row = static_cast<size_t>(y) * a.stride;
+        if (std::memcmp(a.data.data() + row, b.data.data() + row, a.width) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void testKernelsMatchScalar() {
+    std::vector<BlurKernel> kernels;
+    if (static_cast<int>(detectBlurKernel()) >= static_cast<int>(BlurKernel::SSE2)) {
+        kernels.push_back(BlurKernel::SSE2);
+    }
+    if (detectBlurKernel() == BlurKernel::AVX2) {
+        kernels.push_back(BlurKernel::AVX2);
+    }
+    std::printf("best blur kernel: %s\n", blurKernelName(detectBlurKernel()));
+
+    // 宽度覆盖向量宽度（16/32列）的前后和剩余的尾部列
+    const int widths[] = {1, 3, 7, 15, 16, 17, 31, 32, 33, 47, 63, 65, 97, 129, 255};
+    const int heights[] = {1, 2, 5, 19, 64};
+    const int paddings[] = {0, 1, 3, 12};
+    const double sigmas[] = {0.5, 1.0, 2.5, 6.0, 20.0};
+
+    std::mt19937 random(2024);
+    for (int width : widths) {
+        for (int height : heights) {
+            int padding = paddings[(width + height) % 4];
+            double sigma = sigmas[(width * 7 + height) % 5];
+            Image source = randomImage(random, width, height, padding);
+
+            Image reference = source;
+            gaussianBlurA8(reference.data.data(), width, height, reference.stride, sigma, BlurKernel::Scalar);
+            SGUI_CHECK(paddingIntact(reference));
+
+            for (BlurKernel kernel : kernels) {
+                Image result = source;
+                gaussianBlurA8(result.data.data(), width, height, result.stride, sigma, kernel);
+                bool same = sameContent(result, reference);
+                if (!same) {
+                    std::fprintf(stderr, "%s differs from Scalar: %dx%d stride %d sigma %.1f\n", blurKernelName(kernel),
+                                 width, height, result.stride, sigma);
+                }
+                SGUI_CHECK(same);
+                SGUI_CHECK(paddingIntact(result));
+            }
+        }
+    }
+}
+
+void testAllSigmasOnOneImage() {
+    // 同一幅图像上的一组模糊半径，包括超过图像尺寸的半径
+    std::mt19937 random(77);
+    Image source = randomImage(random, 61, 43, 7);
+    for (double sigma : {0.3, 0.8, 1.5, 3.0, 4.5, 8.0, 12.0, 40.0}) {
+        Image reference = source;
+        gaussianBlurA8(reference.data.data(), source.width, source.height, source.stride, sigma, BlurKernel::Scalar);
+
+        Image result = source;
+        gaussianBlurA8(result.data.data(), source.width, source.height, source.stride, sigma);
+        SGUI_CHECK(sameContent(result, reference));
+        SGUI_CHECK(paddingIntact(result));
+    }
+}
+
+} // namespace
+
+int main() {
+    testKernelsMatchScalar();
+    testAllSigmasOnOneImage();
+    return sgui_test::finish("test_blur");
+}
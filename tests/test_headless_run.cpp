@@ -0,0 +1,75 @@
+/**
+ * 无窗口主循环测试
+ *
+ * 检查无窗口模式下Run()的退出条件：等待线程池中的任务和它们的完成回调，
+ * 一次性定时器推进虚拟时钟直到执行，只剩下重复定时器时返回而不是无限推进虚拟时钟
+ */
+
+#include <sgui_container.h>
+#include <sgui_thread_pool.h>
+#include <sgui_timer.h>
+#include <sgui_window.h>
+#include "sgui_test.h"
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace sgui;
+
+namespace {
+
+std::shared_ptr<SWindow> createWindow(SWindowManager& manager) {
+    auto window = manager.CreateWindow(120, 80, "headless run");
+    SGUI_CHECK(window != nullptr);
+    if (window) {
+        auto root = std::make_shared<SContainer>();
+        root->setBackgroundColor(Color::White());
+        window->SetRootContainer(root);
+    }
+    return window;
+}
+
+void testRepeatingTimerDoesNotKeepRunning() {
+    SWindowManager manager(WindowBackend::Headless);
+    auto window = createWindow(manager);
+
+    STimerService& timers = manager.GetTimerService();
+    int ticks = 0;
+    bool fired = false;
+    TimerId interval = timers.setInterval(500, [&ticks]() { ticks++; });
+    timers.setTimeout(1200, [&fired]() { fired = true; });
+
+    auto start = manager.Now();
+    manager.Run();
+
+    // 一次性定时器执行后只剩下重复定时器，Run()返回
+    SGUI_CHECK(fired);
+    SGUI_CHECK_EQ(ticks, 2);
+    SGUI_CHECK(manager.Now() - start < std::chrono::milliseconds(1500));
+    timers.clearTimer(interval);
+}
+
+void testWaitsForPoolWork() {
+    SWindowManager manager(WindowBackend::Headless);
+    auto window = createWindow(manager);
+
+    bool completed = false;
+    SThreadPool::instance().submit(
+        []() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            return 42;
+        },
+        [&completed](int value) { completed = value == 42; });
+
+    // 任务在后台执行时任务队列和定时器都是空的，Run()仍然要等待它的完成回调
+    manager.Run();
+    SGUI_CHECK(completed);
+}
+
+} // namespace
+
+int main() {
+    testRepeatingTimerDoesNotKeepRunning();
+    testWaitsForPoolWork();
+    return sgui_test::finish("test_headless_run");
+}
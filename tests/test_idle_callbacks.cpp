@@ -0,0 +1,112 @@
+/**
+ * 空闲回调测试
+ *
+ * 使用无窗口模式和虚拟时钟：窗口持续渲染（动画帧）时，无论是否限制帧率，
+ * 没有超时的空闲回调都能在帧之间得到非空的空闲时段并执行；没有帧需要渲染时空闲时段最长50ms
+ */
+
+#include <sgui_container.h>
+#include <sgui_timer.h>
+#include <sgui_window.h>
+#include "sgui_test.h"
+#include <chrono>
+#include <functional>
+#include <memory>
+
+using namespace sgui;
+
+namespace {
+
+const auto kFrame = std::chrono::milliseconds(16);
+
+struct IdleResult {
+    bool ran = false;
+    bool didTimeout = false;
+    double remaining = 0.0;
+};
+
+// 在持续请求动画帧的窗口上执行frames帧，返回空闲回调的执行结果
+IdleResult runAnimating(double targetFps, int frames) {
+    SWindowManager manager(WindowBackend::Headless);
+    auto window = manager.CreateWindow(200, 100, "idle");
+    SGUI_CHECK(window != nullptr);
+    if (!window) {
+        return {};
+    }
+    window->SetTargetFrameRate(targetFps);
+
+    auto root = std::make_shared<SContainer>();
+    root->setBackgroundColor(Color::White());
+    window->SetRootContainer(root);
+
+    // 动画每帧修改背景并请求下一帧
+    STimerService& timers = manager.GetTimerService();
+    int frame = 0;
+    std::function<void(std::chrono::steady_clock::time_point)> animate =
+        [&](std::chrono::steady_clock::time_point) {
+            frame++;
+            root->setBackgroundColor(frame % 2 ? Color::LightGray() : Color::White());
+            timers.requestAnimationFrame(animate);
+        };
+    timers.requestAnimationFrame(animate);
+
+    IdleResult result;
+    manager.RequestIdleCallback([&result](const IdleDeadline& deadline) {
+        result.ran = true;
+        result.didTimeout = deadline.didTimeout();
+        result.remaining = deadline.timeRemaining();
+    });
+
+    for (int i = 0; i < frames && !result.ran; ++i) {
+        manager.RunFrame();
+        manager.AdvanceTime(kFrame);
+    }
+    SGUI_CHECK(frame > 0);
+    return result;
+}
+
+void testUnlimitedFrameRate() {
+    // 默认不限制帧率：空闲时段为名义帧预算的剩余部分，不能总是为空
+    IdleResult result = runAnimating(0.0, 5);
+    SGUI_CHECK(result.ran);
+    SGUI_CHECK(!result.didTimeout);
+    SGUI_CHECK(result.remaining > 0.0);
+    SGUI_CHECK(result.remaining <= 1000.0 / 60.0 + 0.001);
+}
+
+void testCappedFrameRate() {
+    // 限制帧率时空闲时段到下一帧的计划时间点为止
+    IdleResult result = runAnimating(60.0, 5);
+    SGUI_CHECK(result.ran);
+    SGUI_CHECK(!result.didTimeout);
+    SGUI_CHECK(result.remaining > 0.0);
+    SGUI_CHECK(result.remaining <= 1000.0 / 60.0 + 0.001);
+}
+
+void testNoFramesPending() {
+    SWindowManager manager(WindowBackend::Headless);
+    auto window = manager.CreateWindow(200, 100, "idle");
+    SGUI_CHECK(window != nullptr);
+
+    // 第一帧渲染后没有任何窗口需要渲染
+    manager.RunFrame();
+
+    IdleResult result;
+    manager.RequestIdleCallback([&result](const IdleDeadline& deadline) {
+        result.ran = true;
+        result.remaining = deadline.timeRemaining();
+    });
+    manager.RunFrame();
+    SGUI_CHECK(result.ran);
+    SGUI_CHECK(result.remaining > 0.0);
+    SGUI_CHECK(result.remaining <= 50.0);
+}
+
+} // namespace
+
+int main() {
+    testUnlimitedFrameRate();
+    testCappedFrameRate();
+    testNoFramesPending();
+    return sgui_test::finish("test_idle_callbacks");
+}
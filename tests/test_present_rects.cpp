@@ -0,0 +1,110 @@
+/**
+ * 呈现矩形合并测试
+ *
+ * 检查代价模型：浪费面积不超过固定开销的矩形对总是合并，相距很远的大矩形保持分开，
+ * 结果不超过矩形数上限，并且总是覆盖所有输入矩形
+ */
+
+#include "internal/sgui_present_rects.h"
+#include "sgui_test.h"
+#include <random>
+
+using namespace sgui;
+
+namespace {
+
+bool contains(const cairo_rectangle_int_t& outer, const cairo_rectangle_int_t& inner) {
+    return inner.x >= outer.x && inner.y >= outer.y && inner.x + inner.width <= outer.x + outer.width &&
+           inner.y + inner.height <= outer.y + outer.height;
+}
+
+bool covers(const std::vector<cairo_rectangle_int_t>& merged, const std::vector<cairo_rectangle_int_t>& input) {
+    for (const auto& rect : input) {
+        bool found = false;
+        for (const auto& candidate : merged) {
+            found = found || contains(candidate, rect);
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void testTrivialInputs() {
+    std::vector<cairo_rectangle_int_t> rects;
+    mergePresentRects(rects, 8);
+    SGUI_CHECK(rects.empty());
+
+    rects = {{5, 6, 7, 8}};
+    mergePresentRects(rects, 8);
+    SGUI_CHECK_EQ(rects.size(), 1u);
+    SGUI_CHECK(rects[0].x == 5 && rects[0].y == 6 && rects[0].width == 7 && rects[0].height == 8);
+}
+
+void testAdjacentRectsMerge() {
+    // 相邻的两条没有浪费
+    std::vector<cairo_rectangle_int_t> rects = {{0, 0, 100, 10}, {100, 0, 100, 10}};
+    mergePresentRects(rects, 8);
+    SGUI_CHECK_EQ(rects.size(), 1u);
+    SGUI_CHECK(rects[0].x == 0 && rects[0].y == 0 && rects[0].width == 200 && rects[0].height == 10);
+
+    // 两个接近的小矩形：浪费100像素，小于一个矩形的固定开销
+    rects = {{0, 0, 10, 10}, {20, 0, 10, 10}};
+    mergePresentRects(rects, 8);
+    SGUI_CHECK_EQ(rects.size(), 1u);
+    SGUI_CHECK(rects[0].width == 30 && rects[0].height == 10);
+}
+
+void testDistantRectsStayApart() {
+    std::vector<cairo_rectangle_int_t> input = {{0, 0, 100, 100}, {1000, 1000, 100, 100}};
+    std::vector<cairo_rectangle_int_t> rects = input;
+    mergePresentRects(rects, 8);
+    SGUI_CHECK_EQ(rects.size(), 2u);
+    SGUI_CHECK(covers(rects, input));
+}
+
+void testRectLimitForcesMerge() {
+    // 20个相距很远的矩形，合并不划算，但结果不能超过上限
+    std::vector<cairo_rectangle_int_t> input;
+    for (int i = 0; i < 20; ++i) {
+        input.push_back({(i % 5) * 400, (i / 5) * 400, 50, 50});
+    }
+    std::vector<cairo_rectangle_int_t> rects = input;
+    mergePresentRects(rects, 8);
+    SGUI_CHECK_EQ(rects.size(), 8u);
+    SGUI_CHECK(covers(rects, input));
+}
+
+void testRandomRegionsAreCovered() {
+    std::mt19937 random(12345);
+    std::uniform_int_distribution<int> position(0, 1900);
+    std::uniform_int_distribution<int> size(1, 120);
+    std::uniform_int_distribution<int> count(1, 40);
+
+    for (int round = 0; round < 200; ++round) {
+        std::vector<cairo_rectangle_int_t> input;
+        int n = count(random);
+        for (int i = 0; i < n; ++i) {
+            input.push_back({position(random), position(random), size(random), size(random)});
+        }
+
+        std::vector<cairo_rectangle_int_t> rects = input;
+        mergePresentRects(rects, 8);
+        SGUI_CHECK(!rects.empty());
+        SGUI_CHECK(rects.size() <= 8u);
+        SGUI_CHECK(rects.size() <= input.size());
+        SGUI_CHECK(covers(rects, input));
+    }
+}
+
+} // namespace
+
+int main() {
+    testTrivialInputs();
+    testAdjacentRectsMerge();
+    testDistantRectsStayApart();
+    testRectLimitForcesMerge();
+    testRandomRegionsAreCovered();
+    return sgui_test::finish("test_present_rects");
+}
@@ -0,0 +1,108 @@
+/**
+ * UI任务队列测试
+ *
+ * 检查任务按投递顺序执行、drain期间投递的任务留到下一次执行、
+ * 同一轮的多次投递只请求一次唤醒，以及多个线程并发投递时不丢失任务
+ */
+
+#include "internal/sgui_task_queue.h"
+#include "sgui_test.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace sgui;
+
+namespace {
+
+void testDrainRunsInOrder() {
+    STaskQueue queue;
+    std::vector<int> order;
+
+    SGUI_CHECK(queue.empty());
+    SGUI_CHECK(queue.push([&order]() { order.push_back(1); }));
+    // 消费者还没有drain，后续投递不需要再次唤醒
+    SGUI_CHECK(!queue.push([&order]() { order.push_back(2); }));
+    SGUI_CHECK(!queue.push([&order]() { order.push_back(3); }));
+    SGUI_CHECK(!queue.empty());
+
+    SGUI_CHECK_EQ(queue.drain(), 3u);
+    SGUI_CHECK_EQ(order.size(), 3u);
+    SGUI_CHECK(order == std::vector<int>({1, 2, 3}));
+    SGUI_CHECK(queue.empty());
+
+    // drain之后的第一次投递重新请求唤醒
+    SGUI_CHECK(queue.push([]() {}));
+    SGUI_CHECK_EQ(queue.drain(), 1u);
+    SGUI_CHECK_EQ(queue.drain(), 0u);
+}
+
+void testTasksPostedDuringDrainRunNext() {
+    STaskQueue queue;
+    int runs = 0;
+    queue.push([&]() {
+        runs++;
+        // 任务中再投递的任务不在本次drain执行，并且需要重新唤醒
+        SGUI_CHECK(queue.push([&runs]() { runs++; }));
+    });
+
+    SGUI_CHECK_EQ(queue.drain(), 1u);
+    SGUI_CHECK_EQ(runs, 1);
+    SGUI_CHECK(!queue.empty());
+    SGUI_CHECK_EQ(queue.drain(), 1u);
+    SGUI_CHECK_EQ(runs, 2);
+}
+
+void testConcurrentProducers() {
+    constexpr int kProducers = 4;
+    constexpr int kTasksPerProducer = 20000;
+
+    STaskQueue queue;
+    std::vector<int> lastSeen(kProducers, -1);
+    int executed = 0;
+    bool ordered = true;
+    std::atomic<int> wakeups{0};
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < kTasksPerProducer; ++i) {
+                // 任务只在消费者线程执行，不需要同步
+                bool wake = queue.push([&, p, i]() {
+                    ordered = ordered && lastSeen[p] == i - 1;
+                    lastSeen[p] = i;
+                    executed++;
+                });
+                if (wake) {
+                    wakeups++;
+                }
+            }
+        });
+    }
+
+    int drains = 0;
+    while (executed < kProducers * kTasksPerProducer) {
+        queue.drain();
+        drains++;
+        std::this_thread::yield();
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    SGUI_CHECK_EQ(executed, kProducers * kTasksPerProducer);
+    SGUI_CHECK(ordered);
+    SGUI_CHECK(queue.empty());
+    // 每次drain之后最多一个投递者负责唤醒
+    SGUI_CHECK(wakeups.load() >= 1);
+    SGUI_CHECK(wakeups.load() <= drains + 1);
+}
+
+} // namespace
+
+int main() {
+    testDrainRunsInOrder();
+    testTasksPostedDuringDrainRunNext();
+    testConcurrentProducers();
+    return sgui_test::finish("test_task_queue");
+}
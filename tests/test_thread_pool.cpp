@@ -0,0 +1,119 @@
+/**
+ * 线程池测试
+ *
+ * 检查带完成回调的提交：结果和完成回调通过投递函数回到“UI线程”执行，
+ * 任务抛出的异常交给错误回调而不是终止工作线程，没有错误回调时异常被丢弃且线程池继续工作
+ */
+
+#include <sgui_thread_pool.h>
+#include "sgui_test.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace sgui;
+
+namespace {
+
+// 模拟UI线程的任务队列
+std::mutex g_mutex;
+std::condition_variable g_posted;
+std::deque<SThreadPool::Task> g_tasks;
+
+void post(SThreadPool::Task task) {
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_tasks.push_back(std::move(task));
+    }
+    g_posted.notify_all();
+}
+
+// 在当前线程执行投递的任务，直到条件成立或超时
+template <typename Predicate>
+bool runUntil(Predicate done) {
+    auto limit = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!done()) {
+        SThreadPool::Task task;
+        {
+            std::unique_lock<std::mutex> lock(g_mutex);
+            if (!g_posted.wait_until(lock, limit, [] { return !g_tasks.empty(); })) {
+                return false;
+            }
+            task = std::move(g_tasks.front());
+            g_tasks.pop_front();
+        }
+        task();
+    }
+    return true;
+}
+
+void testCompletionRunsOnDispatcher() {
+    std::thread::id uiThread = std::this_thread::get_id();
+    int result = 0;
+    bool onUiThread = false;
+    SThreadPool::instance().submit([]() { return 6 * 7; },
+                                   [&](int value) {
+                                       result = value;
+                                       onUiThread = std::this_thread::get_id() == uiThread;
+                                   });
+    SGUI_CHECK(runUntil([&] { return result != 0; }));
+    SGUI_CHECK_EQ(result, 42);
+    SGUI_CHECK(onUiThread);
+}
+
+void testExceptionGoesToErrorHandler() {
+    bool completed = false;
+    std::string message;
+    SThreadPool::instance().submit(
+        []() -> int { throw std::runtime_error("decode failed"); },
+        [&completed](int) { completed = true; },
+        [&message](std::exception_ptr error) {
+            try {
+                std::rethrow_exception(error);
+            } catch (const std::runtime_error& e) {
+                message = e.what();
+            }
+        });
+    SGUI_CHECK(runUntil([&] { return !message.empty(); }));
+    SGUI_CHECK(message == "decode failed");
+    SGUI_CHECK(!completed);
+
+    // 无返回值的任务
+    bool failed = false;
+    SThreadPool::instance().submit([]() { throw 7; }, [&completed]() { completed = true; },
+                                   [&failed](std::exception_ptr error) { failed = error != nullptr; });
+    SGUI_CHECK(runUntil([&] { return failed; }));
+    SGUI_CHECK(!completed);
+}
+
+void testExceptionWithoutHandlerKeepsPoolAlive() {
+    // 没有错误回调：异常被丢弃，工作线程继续执行后续任务
+    bool completed = false;
+    for (size_t i = 0; i < SThreadPool::instance().getThreadCount() * 2; ++i) {
+        SThreadPool::instance().submit([]() { throw std::logic_error("ignored"); }, [&completed]() { completed = true; });
+    }
+    SGUI_CHECK(SThreadPool::instance().waitIdleFor(std::chrono::seconds(5)));
+
+    int result = 0;
+    SThreadPool::instance().submit([]() { return 1; }, [&result](int value) { result = value; });
+    SGUI_CHECK(runUntil([&] { return result != 0; }));
+    SGUI_CHECK(!completed);
+}
+
+} // namespace
+
+int main() {
+    SThreadPool::configure(2);
+    SThreadPool::setCompletionDispatcher(post);
+
+    testCompletionRunsOnDispatcher();
+    testExceptionGoesToErrorHandler();
+    testExceptionWithoutHandlerKeepsPoolAlive();
+
+    SThreadPool::setCompletionDispatcher(nullptr);
+    return sgui_test::finish("test_thread_pool");
+}
@@ -0,0 +1,191 @@
+/**
+ * 图块并行光栅化测试
+ *
+ * 在无窗口渲染器上把同一个帧显示列表分别串行回放和按图块并行回放，逐字节比较输出：
+ * 整帧重绘、只重绘损坏区域，以及线程池被其他任务占满时调用线程自己回放剩余图块
+ */
+
+#include <sgui_cairo_renderer.h>
+#include <sgui_container.h>
+#include <sgui_display_list.h>
+#include <sgui_thread_pool.h>
+#include "sgui_test.h"
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace sgui;
+
+namespace {
+
+// 尺寸不是图块边长的整数倍，覆盖边缘的不完整图块
+const int kWidth = 517;
+const int kHeight = 389;
+const int kTileSize = 64;
+
+std::shared_ptr<SContainer> buildTree() {
+    auto root = std::make_shared<SContainer>();
+    root->setBackgroundColor(Color::White());
+    root->setFlexDirection(FlexDirection::Row);
+    root->setFlexWrap(FlexWrap::Wrap);
+    root->setPadding(EdgeInsets::All(5.0f));
+
+    const Color colors[] = {Color::LightGray(), Color::Silver(), Color::Aqua(), Color::Pink(), Color::Lime()};
+    for (int i = 0; i < 40; ++i) {
+        auto cell = std::make_shared<SContainer>();
+        cell->setWidth(LayoutValue::Point(90));
+        cell->setHeight(LayoutValue::Point(37));
+        cell->setMargin(EdgeInsets::All(3.0f));
+        cell->setBorder(EdgeInsets::All(1.0f));
+        cell->setBorderColor(Color::DarkGray());
+        cell->setBorderRadius(EdgeInsets::All(6.0f));
+        cell->setBackgroundColor(colors[i % 5]);
+        cell->setFontSize(13.0f);
+        cell->setText("Item " + std::to_string(i));
+        root->addChild(cell);
+    }
+    root->calculateLayout(kWidth, kHeight);
+    return root;
+}
+
+std::vector<unsigned char> snapshot(SCairoRenderer& renderer) {
+    cairo_surface_t* surface = renderer.getBackSurface();
+    cairo_surface_flush(surface);
+    const unsigned char* data = cairo_image_surface_get_data(surface);
+    int stride = cairo_image_surface_get_stride(surface);
+
+    // 只比较可见像素，行尾的填充字节不参与比较
+    std::vector<unsigned char> pixels;
+    for (int y = 0; y < kHeight; ++y) {
+        const unsigned char* row = data + static_cast<size_t>(y) * stride;
+        pixels.insert(pixels.end(), row, row + kWidth * 4);
+    }
+    return pixels;
+}
+
+// 把后缓冲清为透明，确保比较的是本次回放的结果
+void clear(SCairoRenderer& renderer) {
+    renderer.begin();
+    cairo_t* cr = renderer.getContext();
+    cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+    cairo_paint(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+    renderer.end();
+}
+
+std::vector<unsigned char> render(SCairoRenderer& renderer, const SDisplayList& list, const cairo_region_t* damage) {
+    clear(renderer);
+    renderer.begin();
+    renderer.rasterize(list, damage);
+    renderer.end();
+    return snapshot(renderer);
+}
+
+bool hasContent(const std::vector<unsigned char>& pixels) {
+    // 背景为白色，格子有颜色：至少要有一部分不是白色也不是透明的像素
+    size_t colored = 0;
+    for (size_t i = 0; i + 3 < pixels.size(); i += 4) {
+        bool white = pixels[i] == 0xff && pixels[i + 1] == 0xff && pixels[i + 2] == 0xff;
+        bool transparent = pixels[i + 3] == 0;
+        colored += (!white && !transparent) ? 1 : 0;
+    }
+    return colored > pixels.size() / 4 / 10;
+}
+
+void testFullFrame(const SDisplayList& list) {
+    SCairoRenderer serial(nullptr, kWidth, kHeight);
+    serial.setTileSize(kTileSize);
+    serial.setRasterThreads(1);
+    std::vector<unsigned char> reference = render(serial, list, nullptr);
+    SGUI_CHECK(hasContent(reference));
+    SGUI_CHECK_EQ(serial.getRasterStats().threads, 1u);
+
+    for (int threads : {0, 2, 3}) {
+        SCairoRenderer tiled(nullptr, kWidth, kHeight);
+        tiled.setTileSize(kTileSize);
+        tiled.setRasterThreads(threads);
+        std::vector<unsigned char> pixels = render(tiled, list, nullptr);
+        SGUI_CHECK(pixels == reference);
+
+        uint64_t expectedTiles = ((kWidth + kTileSize - 1) / kTileSize) * ((kHeight + kTileSize - 1) / kTileSize);
+        SGUI_CHECK_EQ(tiled.getRasterStats().tiles, expectedTiles);
+    }
+}
+
+void testDamageRegion(const SDisplayList& list) {
+    // 两个跨越图块边界的损坏矩形，区域外的像素必须保持清除后的状态
+    cairo_rectangle_int_t rects[] = {{50, 40, 150, 90}, {300, 200, 120, 130}};
+    cairo_region_t* damage = cairo_region_create_rectangles(rects, 2);
+
+    SCairoRenderer serial(nullptr, kWidth, kHeight);
+    serial.setTileSize(kTileSize);
+    serial.setRasterThreads(1);
+    std::vector<unsigned char> reference = render(serial, list, damage);
+
+    SCairoRenderer tiled(nullptr, kWidth, kHeight);
+    tiled.setTileSize(kTileSize);
+    tiled.setRasterThreads(0);
+    std::vector<unsigned char> pixels = render(tiled, list, damage);
+    SGUI_CHECK(pixels == reference);
+    SGUI_CHECK(tiled.getRasterStats().tiles < static_cast<uint64_t>((kWidth / kTileSize + 1) * (kHeight / kTileSize + 1)));
+
+    // 损坏区域外没有被绘制
+    size_t outside = (static_cast<size_t>(10) * kWidth + 10) * 4;
+    SGUI_CHECK_EQ(pixels[outside + 3], 0);
+
+    cairo_region_destroy(damage);
+}
+
+void testBusyPool(const SDisplayList& list) {
+    SCairoRenderer serial(nullptr, kWidth, kHeight);
+    serial.setTileSize(kTileSize);
+    serial.setRasterThreads(1);
+    std::vector<unsigned char> reference = render(serial, list, nullptr);
+
+    // 占满所有工作线程，光栅化不能等待排队的辅助任务
+    SThreadPool& pool = SThreadPool::instance();
+    std::mutex mutex;
+    std::condition_variable released;
+    bool release = false;
+    std::vector<std::future<void>> blockers;
+    for (size_t i = 0; i < pool.getThreadCount(); ++i) {
+        blockers.push_back(pool.submit([&]() {
+            std::unique_lock<std::mutex> lock(mutex);
+            released.wait(lock, [&release]() { return release; });
+        }));
+    }
+
+    SCairoRenderer tiled(nullptr, kWidth, kHeight);
+    tiled.setTileSize(kTileSize);
+    tiled.setRasterThreads(0);
+    std::vector<unsigned char> pixels = render(tiled, list, nullptr);
+    SGUI_CHECK(pixels == reference);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        release = true;
+    }
+    released.notify_all();
+    for (auto& blocker : blockers) {
+        blocker.get();
+    }
+}
+
+} // namespace
+
+int main() {
+    SThreadPool::configure(3);
+
+    auto root = buildTree();
+    SDisplayList list;
+    root->recordDisplayList(list, CAIRO_ANTIALIAS_SUBPIXEL);
+    SGUI_CHECK(!list.empty());
+
+    testFullFrame(list);
+    testDamageRegion(list);
+    testBusyPool(list);
+    return sgui_test::finish("test_tiled_raster");
+}
@@ -0,0 +1,205 @@
+/**
+ * 定时器服务测试
+ *
+ * 使用虚拟时钟驱动分层时间轮：检查定时器不早于也不晚于到期时间执行，
+ * 跨层降级的长定时器、重复定时器、回调中取消、nextDeadline和动画帧回调
+ */
+
+#include "sgui_timer.h"
+#include "sgui_test.h"
+#include <memory>
+#include <vector>
+
+using namespace sgui;
+using Clock = STimerService::Clock;
+
+namespace {
+
+// 手动推进的虚拟时钟
+struct VirtualClock {
+    Clock::time_point start = Clock::now();
+    Clock::time_point now = start;
+
+    STimerService::ClockFunction function() {
+        return [this]() { return now; };
+    }
+    void set(uint64_t ms) { now = start + std::chrono::milliseconds(ms); }
+};
+
+void testTimeoutFiresAtDeadline() {
+    VirtualClock clock;
+    STimerService timers(clock.function());
+    int fired = 0;
+    timers.setTimeout(10, [&fired]() { fired++; });
+
+    clock.set(9);
+    SGUI_CHECK_EQ(timers.advance(), 0u);
+    SGUI_CHECK_EQ(fired, 0);
+
+    clock.set(10);
+    SGUI_CHECK_EQ(timers.advance(), 1u);
+    SGUI_CHECK_EQ(fired, 1);
+    SGUI_CHECK(!timers.hasTimers());
+
+    clock.set(100);
+    SGUI_CHECK_EQ(timers.advance(), 0u);
+    SGUI_CHECK_EQ(fired, 1);
+}
+
+void testLongTimersCascade() {
+    // 覆盖每一层的边界以及超出时间轮范围（2^24ms）的定时器
+    const uint64_t delays[] = {1, 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 300000, 16777215, 20000000};
+    for (uint64_t delay : delays) {
+        VirtualClock clock;
+        STimerService timers(clock.function());
+        int fired = 0;
+        timers.setTimeout(static_cast<uint32_t>(delay), [&fired]() { fired++; });
+
+        // 一次推进到到期前1ms，跨过的层都要正确降级而不提前执行
+        clock.set(delay - 1);
+        timers.advance();
+        if (fired != 0) {
+            std::fprintf(stderr, "timer with delay %llu fired early\n", static_cast<unsigned long long>(delay));
+        }
+        SGUI_CHECK_EQ(fired, 0);
+
+        clock.set(delay);
+        timers.advance();
+        if (fired != 1) {
+            std::fprintf(stderr, "timer with delay %llu did not fire on time\n", static_cast<unsigned long long>(delay));
+        }
+        SGUI_CHECK_EQ(fired, 1);
+    }
+}
+
+void testNextDeadlineNeverLate() {
+    // 按nextDeadline睡眠再推进，模拟主循环的等待超时：每次醒来都不能晚于到期时间
+    const uint64_t delays[] = {7, 100, 5000, 300000};
+    for (uint64_t delay : delays) {
+        VirtualClock clock;
+        STimerService timers(clock.function());
+        uint64_t firedAt = 0;
+        timers.setTimeout(static_cast<uint32_t>(delay), [&]() {
+            firedAt = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(clock.now - clock.start).count());
+        });
+
+        int wakeups = 0;
+        Clock::time_point deadline;
+        while (timers.nextDeadline(deadline) && wakeups < 100) {
+            SGUI_CHECK(deadline <= clock.start + std::chrono::milliseconds(delay));
+            SGUI_CHECK(deadline > clock.now);
+            clock.now = deadline;
+            timers.advance();
+            wakeups++;
+        }
+        SGUI_CHECK_EQ(firedAt, delay);
+        // 每层最多降级一次，醒来次数与层数同级
+        SGUI_CHECK(wakeups <= 8);
+    }
+}
+
+void testIntervalAndCancelInCallback() {
+    VirtualClock clock;
+    STimerService timers(clock.function());
+    int runs = 0;
+    TimerId id = 0;
+    id = timers.setInterval(5, [&]() {
+        runs++;
+        if (runs == 3) {
+            timers.clearTimer(id);
+        }
+    });
+
+    // 逐毫秒推进
+    for (uint64_t ms = 1; ms <= 14; ++ms) {
+        clock.set(ms);
+        timers.advance();
+    }
+    SGUI_CHECK_EQ(runs, 2);
+
+    clock.set(15);
+    timers.advance();
+    SGUI_CHECK_EQ(runs, 3);
+
+    clock.set(100);
+    timers.advance();
+    SGUI_CHECK_EQ(runs, 3);
+    SGUI_CHECK(!timers.hasTimers());
+
+    // 一次跨过多个间隔时，重复定时器每个间隔执行一次
+    int ticks = 0;
+    timers.setInterval(10, [&ticks]() { ticks++; });
+    clock.set(150);
+    timers.advance();
+    SGUI_CHECK_EQ(ticks, 5);
+}
+
+void testClearTimerBeforeExpiry() {
+    VirtualClock clock;
+    STimerService timers(clock.function());
+    int fired = 0;
+    TimerId id = timers.setTimeout(1000, [&fired]() { fired++; });
+    timers.setTimeout(2000, [&fired]() { fired += 10; });
+    timers.clearTimer(id);
+
+    clock.set(5000);
+    timers.advance();
+    SGUI_CHECK_EQ(fired, 10);
+}
+
+void testAnimationFrames() {
+    VirtualClock clock;
+    STimerService timers(clock.function());
+    int frames = 0;
+    timers.requestAnimationFrame([&](Clock::time_point) {
+        frames++;
+        // 回调中请求的动画帧留到下一帧
+        timers.requestAnimationFrame([&frames](Clock::time_point) { frames++; });
+    });
+    TimerId cancelled = timers.requestAnimationFrame([&frames](Clock::time_point) { frames += 100; });
+    timers.cancelAnimationFrame(cancelled);
+
+    SGUI_CHECK(timers.hasAnimationFrameRequests());
+    SGUI_CHECK_EQ(timers.runAnimationFrames(clock.now), 1u);
+    SGUI_CHECK_EQ(frames, 1);
+    SGUI_CHECK(timers.hasAnimationFrameRequests());
+    SGUI_CHECK_EQ(timers.runAnimationFrames(clock.now), 1u);
+    SGUI_CHECK_EQ(frames, 2);
+    SGUI_CHECK(!timers.hasAnimationFrameRequests());
+}
+
+void testIdsAreUniqueAcrossServices() {
+    VirtualClock clock;
+    auto first = std::make_unique<STimerService>(clock.function());
+    STimerService second(clock.function());
+
+    int fired = 0;
+    TimerId a = first->setTimeout(10, []() {});
+    TimerId b = second.setTimeout(10, [&fired]() { fired++; });
+    SGUI_CHECK(a != b);
+
+    // 用其他服务的ID取消不影响本服务的定时器
+    second.clearTimer(a);
+    clock.set(10);
+    second.advance();
+    SGUI_CHECK_EQ(fired, 1);
+
+    const STimerService* firstPtr = first.get();
+    SGUI_CHECK(STimerService::isAlive(firstPtr));
+    first.reset();
+    SGUI_CHECK(!STimerService::isAlive(firstPtr));
+    SGUI_CHECK(STimerService::isAlive(&second));
+}
+
+} // namespace
+
+int main() {
+    testTimeoutFiresAtDeadline();
+    testLongTimersCascade();
+    testNextDeadlineNeverLate();
+    testIntervalAndCancelInCallback();
+    testClearTimerBeforeExpiry();
+    testAnimationFrames();
+    testIdsAreUniqueAcrossServices();
+    return sgui_test::finish("test_timer");
+}